@@ -452,6 +452,15 @@ void Categories::markNewSearch()
     }
 }
 
+qint64 Categories::memoryUsage() const
+{
+    qint64 size = 0;
+    for (auto const& model: m_categoryResults) {
+        size += model->memoryUsage();
+    }
+    return size;
+}
+
 void Categories::purgeResults()
 {
     QVector<int> roles;
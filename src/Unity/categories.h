@@ -63,6 +63,8 @@ public:
     void clearAll();
     void markNewSearch();
     void purgeResults();
+    // estimated memory used by results of all categories, in bytes
+    qint64 memoryUsage() const;
     void updateResult(unity::scopes::Result const& result, QString const& categoryId, unity::scopes::Result const& updated_result);
 
     static bool parseTemplate(std::string const& raw_template, QJsonValue* renderer, QJsonValue* components);
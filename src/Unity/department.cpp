@@ -22,6 +22,7 @@
 #include <unity/scopes/OptionSelectorFilter.h>
 
 #include <QDebug>
+#include <QVector>
 
 namespace scopes_ng
 {
@@ -29,7 +30,7 @@ namespace scopes_ng
 using namespace unity;
 
 Department::Department(QObject* parent) :
-    unity::shell::scopes::NavigationInterface(parent),
+    ModelUpdate(parent),
     m_loaded(false), m_isRoot(false), m_hidden(false), m_isFilter(false)
 {
 }
@@ -45,68 +46,108 @@ void Department::loadFromDepartmentNode(DepartmentNode* treeNode)
         qWarning("Tried to set null DepartmentNode!");
         return;
     }
-    m_navigationId = treeNode->id();
+    DepartmentNode* parentNode = treeNode->parent();
+    const QString navigationId(treeNode->id());
+    const QString label(treeNode->label());
+    const QString allLabel(treeNode->allLabel());
+    const QString parentNavigationId(parentNode ? parentNode->id() : QLatin1String(""));
+    const QString parentLabel(parentNode ? parentNode->label() : QLatin1String(""));
+    const bool loaded = treeNode->isLeaf() || treeNode->childCount() > 0;
+    const bool isRoot = treeNode->isRoot();
+    const bool hidden = treeNode->hidden();
+
     m_filterId = treeNode->filterId();
-    m_label = treeNode->label();
-    m_allLabel = treeNode->allLabel();
-    m_loaded = treeNode->isLeaf() || treeNode->childCount() > 0;
-    m_isRoot = treeNode->isRoot();
-    m_hidden = treeNode->hidden();
     m_isFilter = treeNode->isFilter();
 
-    DepartmentNode* parentNode = treeNode->parent();
-    m_parentNavigationId = parentNode ? parentNode->id() : QLatin1String("");
-    m_parentLabel = parentNode ? parentNode->label() : QLatin1String("");
-
-    beginResetModel();
-
-    m_subdepartments.clear();
-    Q_FOREACH (DepartmentNode* node, treeNode->childNodes()) {
-        QSharedPointer<SubdepartmentData> subdept(new SubdepartmentData);
-        subdept->id = node->id();
-        subdept->label = node->label();
-        subdept->allLabel = node->allLabel();
-        subdept->hasChildren = node->hasSubdepartments();
-        subdept->isActive = false;
-        m_subdepartments.append(subdept);
+    const int oldCount = m_subdepartments.count();
+
+    syncModel(treeNode->childNodes(), m_subdepartments,
+            // key function for department node
+            [](DepartmentNode* const& node) -> QString { return node->id(); },
+            // key function for subdepartment data
+            [](const QSharedPointer<SubdepartmentData>& subdept) -> QString { return subdept->id; },
+            // factory function
+            [](DepartmentNode* const& node) -> QSharedPointer<SubdepartmentData> {
+                QSharedPointer<SubdepartmentData> subdept(new SubdepartmentData);
+                subdept->id = node->id();
+                subdept->label = node->label();
+                subdept->allLabel = node->allLabel();
+                subdept->hasChildren = node->hasSubdepartments();
+                subdept->isActive = false;
+                return subdept;
+            },
+            // update function
+            [this](int row, DepartmentNode* const& node, const QSharedPointer<SubdepartmentData>& subdept) -> bool {
+                QVector<int> roles;
+                if (subdept->label != node->label()) {
+                    subdept->label = node->label();
+                    roles.append(Roles::RoleLabel);
+                }
+                if (subdept->allLabel != node->allLabel()) {
+                    subdept->allLabel = node->allLabel();
+                    roles.append(Roles::RoleAllLabel);
+                }
+                if (subdept->hasChildren != node->hasSubdepartments()) {
+                    subdept->hasChildren = node->hasSubdepartments();
+                    roles.append(Roles::RoleHasChildren);
+                }
+                // the active subdepartment stays active, markSubdepartmentActive() moves it if needed
+                if (!roles.isEmpty()) {
+                    Q_EMIT dataChanged(index(row, 0), index(row, 0), roles);
+                }
+                return true;
+            });
+
+    if (m_navigationId != navigationId) {
+        m_navigationId = navigationId;
+        Q_EMIT navigationIdChanged();
+    }
+    if (m_label != label) {
+        m_label = label;
+        Q_EMIT labelChanged();
+    }
+    if (m_allLabel != allLabel) {
+        m_allLabel = allLabel;
+        Q_EMIT allLabelChanged();
+    }
+    if (m_parentNavigationId != parentNavigationId) {
+        m_parentNavigationId = parentNavigationId;
+        Q_EMIT parentNavigationIdChanged();
+    }
+    if (m_parentLabel != parentLabel) {
+        m_parentLabel = parentLabel;
+        Q_EMIT parentLabelChanged();
+    }
+    if (m_loaded != loaded) {
+        m_loaded = loaded;
+        Q_EMIT loadedChanged();
+    }
+    if (oldCount != m_subdepartments.count()) {
+        Q_EMIT countChanged();
+    }
+    if (m_isRoot != isRoot) {
+        m_isRoot = isRoot;
+        Q_EMIT isRootChanged();
+    }
+    if (m_hidden != hidden) {
+        m_hidden = hidden;
+        Q_EMIT hiddenChanged();
     }
-
-    endResetModel();
-
-    Q_EMIT navigationIdChanged();
-    Q_EMIT labelChanged();
-    Q_EMIT allLabelChanged();
-    Q_EMIT parentNavigationIdChanged();
-    Q_EMIT parentLabelChanged();
-    Q_EMIT loadedChanged();
-    Q_EMIT countChanged();
-    Q_EMIT isRootChanged();
-    Q_EMIT hiddenChanged();
 }
 
 void Department::markSubdepartmentActive(QString const& subdepartmentId)
 {
-    int idx = -1;
-    bool isActiveReset = false;
-    for (int i = 0; i < m_subdepartments.count(); i++) {
-        if (m_subdepartments[i]->id == subdepartmentId) {
-            m_subdepartments[i]->isActive = true;
-            idx = i;
-        } else if (m_subdepartments[i]->isActive) {
-            // only one department can be active
-            m_subdepartments[i]->isActive = false;
-            isActiveReset = true;
-        }
-    }
-
-    if (idx < 0) return;
-
     QVector<int> roles;
     roles.append(Roles::RoleIsActive);
 
-    QModelIndex startIndex(index(isActiveReset ? 0 : idx));
-    QModelIndex endIndex(index(isActiveReset ? m_subdepartments.count() - 1 : idx));
-    dataChanged(startIndex, endIndex, roles);
+    // only one department can be active; rows that keep their state aren't notified
+    for (int i = 0; i < m_subdepartments.count(); i++) {
+        const bool isActive = m_subdepartments[i]->id == subdepartmentId;
+        if (m_subdepartments[i]->isActive != isActive) {
+            m_subdepartments[i]->isActive = isActive;
+            Q_EMIT dataChanged(index(i), index(i), roles);
+        }
+    }
 }
 
 QVariant Department::data(const QModelIndex& index, int role) const
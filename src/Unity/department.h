@@ -32,6 +32,7 @@
 #include <unity/scopes/Department.h>
 
 #include "departmentnode.h"
+#include "modelupdate.h"
 
 namespace scopes_ng
 {
@@ -45,7 +46,10 @@ struct SubdepartmentData
     bool isActive;
 };
 
-class Q_DECL_EXPORT Department : public unity::shell::scopes::NavigationInterface
+class Q_DECL_EXPORT Department :
+    public ModelUpdate<unity::shell::scopes::NavigationInterface,
+        QList<DepartmentNode*>,
+        QList<QSharedPointer<SubdepartmentData>>>
 {
     Q_OBJECT
 
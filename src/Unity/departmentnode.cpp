@@ -26,6 +26,7 @@ using namespace unity;
 
 DepartmentNode::DepartmentNode(DepartmentNode* parent)
     : m_parent(parent)
+    , m_root(parent ? parent->m_root : this)
     , m_isRoot(false)
     , m_hidden(false)
     , m_isFilter(false)
@@ -35,11 +36,12 @@ DepartmentNode::DepartmentNode(DepartmentNode* parent)
 DepartmentNode::~DepartmentNode()
 {
     clearChildren();
+    unregisterNode();
 }
 
 void DepartmentNode::initializeForDepartment(scopes::Department::SCPtr const& dep)
 {
-    m_id = QString::fromStdString(dep->id());
+    setId(QString::fromStdString(dep->id()));
     m_label = QString::fromStdString(dep->label());
     m_allLabel = QString::fromStdString(dep->alternate_label());
     m_hasSubdepartments = dep->has_subdepartments();
@@ -56,10 +58,75 @@ void DepartmentNode::initializeForDepartment(scopes::Department::SCPtr const& de
     }
 }
 
+bool DepartmentNode::updateForDepartment(scopes::Department::SCPtr const& dep, QSet<QString>& changedNodes)
+{
+    const QString id(QString::fromStdString(dep->id()));
+    const QString label(QString::fromStdString(dep->label()));
+    const QString allLabel(QString::fromStdString(dep->alternate_label()));
+    const bool hasSubdepartments = dep->has_subdepartments();
+
+    const bool attributesChanged = id != m_id || label != m_label || allLabel != m_allLabel || hasSubdepartments != m_hasSubdepartments;
+    const bool parentDataChanged = id != m_id || label != m_label;
+    bool changed = attributesChanged || m_hidden || m_isFilter;
+
+    if (id != m_id) {
+        setId(id);
+    }
+    m_label = label;
+    m_allLabel = allLabel;
+    m_hasSubdepartments = hasSubdepartments;
+    m_hidden = false;
+    m_isFilter = false;
+
+    QHash<QString, DepartmentNode*> oldChildren;
+    oldChildren.reserve(m_children.count());
+    Q_FOREACH(DepartmentNode* child, m_children) {
+        if (!oldChildren.contains(child->id())) {
+            oldChildren.insert(child->id(), child);
+        }
+    }
+
+    auto subdeps = dep->subdepartments();
+    QList<DepartmentNode*> children;
+    QSet<DepartmentNode*> reused;
+    children.reserve(static_cast<int>(subdeps.size()));
+    for (auto it = subdeps.begin(); it != subdeps.end(); ++it) {
+        DepartmentNode* child = oldChildren.take(QString::fromStdString((*it)->id()));
+        if (child) {
+            reused.insert(child);
+            if (child->updateForDepartment(*it, changedNodes) || parentDataChanged) {
+                changedNodes.insert(child->id());
+                changed = true;
+            }
+        } else {
+            child = new DepartmentNode(this);
+            child->initializeForDepartment(*it);
+            child->collectIds(changedNodes);
+            changed = true;
+        }
+        children.append(child);
+    }
+
+    if (children != m_children) {
+        changed = true;
+        Q_FOREACH(DepartmentNode* child, m_children) {
+            if (!reused.contains(child)) {
+                delete child;
+            }
+        }
+        m_children = children;
+    }
+
+    if (changed) {
+        changedNodes.insert(m_id);
+    }
+    return attributesChanged;
+}
+
 void DepartmentNode::initializeForFilter(scopes::OptionSelectorFilter::SCPtr const& filter)
 {
     auto children = filter->options();
-    m_id = QLatin1String(""); // this is root (which we shouldn't show really)
+    setId(QLatin1String("")); // this is root (which we shouldn't show really)
     m_filterId = QString::fromStdString(filter->id());
     m_label = QString::fromStdString(filter->label());
     m_allLabel = QString();
@@ -79,7 +146,7 @@ void DepartmentNode::initializeForFilter(scopes::OptionSelectorFilter::SCPtr con
 
 void DepartmentNode::initializeForFilterOption(scopes::FilterOption::SCPtr const& option, QString const& filterId)
 {
-    m_id = QString::fromStdString(option->id());
+    setId(QString::fromStdString(option->id()));
     m_filterId = filterId;
     m_label = QString::fromStdString(option->label());
     m_allLabel = QString();
@@ -113,16 +180,41 @@ bool DepartmentNode::isFilter() const
 
 DepartmentNode* DepartmentNode::findNodeById(QString const& id)
 {
-    if (id == m_id) return this;
+    DepartmentNode* node = m_root->m_index.value(id, nullptr);
+    if (node == nullptr || m_root == this) return node;
 
-    Q_FOREACH(DepartmentNode* child, m_children) {
-        DepartmentNode* node = child->findNodeById(id);
-        if (node) return node;
+    // only return nodes from our own subtree
+    for (DepartmentNode* ancestor = node; ancestor; ancestor = ancestor->m_parent) {
+        if (ancestor == this) return node;
     }
 
     return nullptr;
 }
 
+void DepartmentNode::setId(QString const& id)
+{
+    unregisterNode();
+    m_id = id;
+    // ids are expected to be unique; if they are not, the node registered last wins
+    m_root->m_index.insert(m_id, this);
+}
+
+void DepartmentNode::collectIds(QSet<QString>& ids) const
+{
+    ids.insert(m_id);
+    Q_FOREACH(DepartmentNode* child, m_children) {
+        child->collectIds(ids);
+    }
+}
+
+void DepartmentNode::unregisterNode()
+{
+    auto it = m_root->m_index.find(m_id);
+    if (it != m_root->m_index.end() && it.value() == this) {
+        m_root->m_index.erase(it);
+    }
+}
+
 QString DepartmentNode::id() const
 {
     return m_id;
@@ -150,6 +242,8 @@ bool DepartmentNode::hasSubdepartments() const
 
 void DepartmentNode::appendChild(DepartmentNode* child)
 {
+    // nodes are registered with the index of the tree they were created for
+    Q_ASSERT(child->m_parent == this);
     m_children.append(child);
 }
 
@@ -175,6 +269,7 @@ bool DepartmentNode::isLeaf() const
 
 void DepartmentNode::clearChildren()
 {
+    // deleted nodes unregister themselves from the index
     qDeleteAll(m_children);
     m_children.clear();
 }
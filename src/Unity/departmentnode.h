@@ -22,6 +22,8 @@
 #define NG_DEPARTMENT_NODE_H
 
 #include <QSharedPointer>
+#include <QHash>
+#include <QSet>
 #include <QMultiMap>
 #include <QStringList>
 #include <QPointer>
@@ -38,6 +40,10 @@ public:
     ~DepartmentNode();
 
     void initializeForDepartment(unity::scopes::Department::SCPtr const& dep);
+    // Reconcile the subtree with given department, re-using nodes with matching ids.
+    // Ids of nodes whose navigation models need reloading are added to changedNodes.
+    // Returns true if attributes of this node, as displayed by parent's navigation model, changed.
+    bool updateForDepartment(unity::scopes::Department::SCPtr const& dep, QSet<QString>& changedNodes);
     void initializeForFilter(unity::scopes::OptionSelectorFilter::SCPtr const& filter);
     DepartmentNode* findNodeById(QString const& id);
 
@@ -61,8 +67,13 @@ public:
 private:
     void clearChildren();
     void initializeForFilterOption(unity::scopes::FilterOption::SCPtr const&, QString const&);
+    void setId(QString const& id);
+    void unregisterNode();
+    void collectIds(QSet<QString>& ids) const;
 
     DepartmentNode* m_parent;
+    DepartmentNode* m_root;
+    QHash<QString, DepartmentNode*> m_index; // id -> node lookup for the whole tree, only used by the root node
     QList<DepartmentNode*> m_children;
     QString m_id;
     QString m_label;
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "departmentprefetcher.h"
+#include "collectors.h"
+#include "queryscheduler.h"
+#include "scope.h"
+
+#include <QDebug>
+#include <QEvent>
+
+namespace scopes_ng
+{
+
+using namespace unity;
+
+// Receives results of a single prefetch search.
+class DepartmentPrefetcher::PrefetchSearch : public QObject
+{
+public:
+    PrefetchSearch(DepartmentPrefetcher* prefetcher, DepartmentPrefetchRequest const& request)
+        : QObject(prefetcher)
+        , m_prefetcher(prefetcher)
+        , m_request(request)
+    {
+    }
+
+    bool event(QEvent* ev) override
+    {
+        if (ev->type() != PushEvent::eventType) {
+            return QObject::event(ev);
+        }
+
+        PushEvent* pushEvent = static_cast<PushEvent*>(ev);
+        if (pushEvent->type() == PushEvent::SEARCH) {
+            QList<std::shared_ptr<scopes::CategorisedResult>> results;
+            scopes::Department::SCPtr rootDepartment;
+            QList<scopes::FilterBase::SCPtr> filters;
+
+            auto status = pushEvent->collectSearchResults(results, rootDepartment, filters);
+            if (status == CollectorBase::Status::CANCELLED) {
+                return true;
+            }
+
+            m_search.size += CachedSearch::estimateSize(results);
+            m_search.results.append(results);
+            m_search.rootDepartment = rootDepartment;
+            m_search.filters = filters;
+
+            if (status != CollectorBase::Status::INCOMPLETE) {
+                m_prefetcher->searchFinished(this, status == CollectorBase::Status::FINISHED);
+            }
+        }
+        return true;
+    }
+
+    DepartmentPrefetcher* m_prefetcher;
+    DepartmentPrefetchRequest m_request;
+    CachedSearch m_search;
+    CollectionController m_controller;
+};
+
+DepartmentPrefetcher::DepartmentPrefetcher(QObject* parent)
+    : QObject(parent)
+{
+}
+
+DepartmentPrefetcher::~DepartmentPrefetcher()
+{
+    cancel();
+}
+
+void DepartmentPrefetcher::prefetch(QueryScheduler* scheduler, Scope* scope, scopes::ScopeProxy const& proxy, QString const& searchQuery,
+        scopes::FilterState const& filterState, scopes::SearchMetadata const& metadata, QList<DepartmentPrefetchRequest> const& requests)
+{
+    cancel();
+
+    m_scheduler = scheduler;
+    m_proxy = proxy;
+    m_searchQuery = searchQuery;
+    m_filterState = filterState;
+    m_metadata.reset(new scopes::SearchMetadata(metadata));
+
+    for (auto const& request: requests) {
+        auto search = new PrefetchSearch(this, request);
+        m_searches.append(search);
+        if (m_scheduler) {
+            m_scheduler->scheduleQuery(search, scope, QueryScheduler::Priority::BackgroundPrefetch,
+                    [this, search]() { return startSearch(search); },
+                    [search]() { search->m_controller.invalidate(); });
+        } else {
+            startSearch(search);
+        }
+    }
+}
+
+void DepartmentPrefetcher::cancel()
+{
+    for (PrefetchSearch* search: m_searches) {
+        if (m_scheduler) {
+            m_scheduler->unscheduleQuery(search);
+        }
+        search->m_controller.invalidate();
+        delete search;
+    }
+    m_searches.clear();
+}
+
+bool DepartmentPrefetcher::isActive() const
+{
+    return !m_searches.isEmpty();
+}
+
+bool DepartmentPrefetcher::startSearch(PrefetchSearch* search)
+{
+    // a preempted search starts over
+    search->m_controller.invalidate();
+    search->m_search = CachedSearch();
+
+    scopes::SearchListenerBase::SPtr listener(new SearchResultReceiver(search));
+    search->m_controller.setListener(listener);
+
+    try {
+        qDebug() << "Prefetching department" << search->m_request.departmentId;
+        search->m_controller.setController(
+                m_proxy->search(m_searchQuery.toStdString(), search->m_request.departmentId.toStdString(), m_filterState, *m_metadata, listener));
+        return true;
+    } catch (std::exception& e) {
+        qWarning("Caught an error from create_query(): %s", e.what());
+    } catch (...) {
+        qWarning("Caught an error from create_query()");
+    }
+    search->m_controller.invalidate();
+    m_searches.removeOne(search);
+    search->deleteLater();
+    return false;
+}
+
+void DepartmentPrefetcher::searchFinished(PrefetchSearch* search, bool succeeded)
+{
+    m_searches.removeOne(search);
+    if (m_scheduler) {
+        m_scheduler->unscheduleQuery(search);
+    }
+
+    if (succeeded) {
+        search->m_search.timestamp.start();
+        Q_EMIT departmentPrefetched(search->m_request.cacheKey, search->m_search);
+    }
+
+    // we're called from the event handler of the search object
+    search->deleteLater();
+}
+
+} // namespace scopes_ng
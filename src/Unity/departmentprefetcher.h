@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NG_DEPARTMENT_PREFETCHER_H
+#define NG_DEPARTMENT_PREFETCHER_H
+
+#include <QObject>
+#include <QList>
+#include <QPointer>
+#include <QString>
+
+#include <unity/scopes/FilterState.h>
+#include <unity/scopes/Scope.h>
+#include <unity/scopes/SearchMetadata.h>
+
+#include "searchcache.h"
+
+namespace scopes_ng
+{
+
+class QueryScheduler;
+class Scope;
+
+struct DepartmentPrefetchRequest
+{
+    QString departmentId;
+    QString cacheKey;
+};
+
+/**
+  Runs background searches for departments the user is likely to navigate to next,
+  so that their results can be rendered from the search cache right away.
+*/
+class Q_DECL_EXPORT DepartmentPrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DepartmentPrefetcher(QObject* parent = nullptr);
+    ~DepartmentPrefetcher();
+
+    // Replaces any pending prefetch searches with new ones. The searches are queued in the scheduler
+    // with background priority, or started right away if there's no scheduler.
+    void prefetch(QueryScheduler* scheduler, Scope* scope, unity::scopes::ScopeProxy const& proxy, QString const& searchQuery,
+            unity::scopes::FilterState const& filterState, unity::scopes::SearchMetadata const& metadata,
+            QList<DepartmentPrefetchRequest> const& requests);
+    void cancel();
+    bool isActive() const;
+
+Q_SIGNALS:
+    void departmentPrefetched(QString const& cacheKey, scopes_ng::CachedSearch const& search);
+
+private:
+    class PrefetchSearch;
+    friend class PrefetchSearch;
+
+    bool startSearch(PrefetchSearch* search);
+    void searchFinished(PrefetchSearch* search, bool succeeded);
+
+    QPointer<QueryScheduler> m_scheduler;
+    unity::scopes::ScopeProxy m_proxy;
+    QString m_searchQuery;
+    unity::scopes::FilterState m_filterState;
+    std::unique_ptr<unity::scopes::SearchMetadata> m_metadata;
+    QList<PrefetchSearch*> m_searches;
+};
+
+} // namespace scopes_ng
+
+#endif
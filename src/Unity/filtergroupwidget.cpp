@@ -29,6 +29,7 @@ FilterGroupWidget::FilterGroupWidget(QList<unity::scopes::FilterBase::SCPtr> con
       m_filters(new Filters(filterState, this))
 {
     connect(m_filters, SIGNAL(filterStateChanged()), this, SIGNAL(filterStateChanged()));
+    connect(m_filters, SIGNAL(activeFiltersCountChanged(int)), this, SLOT(onActiveFiltersCountChanged()));
     if (filters.size() > 0) {
         auto group = filters.front()->filter_group();
         Q_ASSERT(group != nullptr);
@@ -80,6 +81,16 @@ int FilterGroupWidget::activeFiltersCount() const
     return m_filters->activeFiltersCount();
 }
 
+void FilterGroupWidget::emitActiveFiltersCountChanged(int delta)
+{
+    Q_EMIT activeFiltersCountChanged(delta);
+}
+
+void FilterGroupWidget::onActiveFiltersCountChanged()
+{
+    refreshActiveFiltersCount();
+}
+
 QString FilterGroupWidget::filterTag() const
 {
     // FilterGroup cannot have primary filters, so no tag
@@ -48,6 +48,13 @@ public:
 
 Q_SIGNALS:
     void filterStateChanged();
+    void activeFiltersCountChanged(int delta);
+
+protected:
+    void emitActiveFiltersCountChanged(int delta) override;
+
+private Q_SLOTS:
+    void onActiveFiltersCountChanged();
 
 private:
     QString m_id;
@@ -38,6 +38,99 @@ namespace scopes_ng
 
 const int FILTER_CHANGE_PROCESSING_DELAY = 300;
 
+using FilterType = unity::shell::scopes::FiltersInterface::FilterType;
+
+namespace
+{
+
+// Call the visitor with the scopes API filter cast to its concrete type, as indicated by the filter type tag.
+template <typename Visitor>
+void visitFilter(unity::scopes::FilterBase::SCPtr const& filter, FilterType filterType, Visitor& visitor)
+{
+    switch (filterType)
+    {
+        case FilterType::OptionSelectorFilter:
+            visitor(std::static_pointer_cast<unity::scopes::OptionSelectorFilter const>(filter));
+            break;
+        case FilterType::RangeInputFilter:
+            visitor(std::static_pointer_cast<unity::scopes::RangeInputFilter const>(filter));
+            break;
+        case FilterType::ValueSliderFilter:
+            visitor(std::static_pointer_cast<unity::scopes::ValueSliderFilter const>(filter));
+            break;
+        default:
+            qWarning() << "Unsupported filter type:" << QString::fromStdString(filter->filter_type());
+            break;
+    }
+}
+
+// Call the visitor with the shell filter object cast to its concrete type, as indicated by filterType().
+template <typename Visitor>
+void visitFilter(unity::shell::scopes::FilterBaseInterface* filter, Visitor& visitor)
+{
+    switch (filter->filterType())
+    {
+        case FilterType::OptionSelectorFilter:
+            visitor(static_cast<OptionSelectorFilter*>(filter));
+            break;
+        case FilterType::RangeInputFilter:
+            visitor(static_cast<RangeInputFilter*>(filter));
+            break;
+        case FilterType::ValueSliderFilter:
+            visitor(static_cast<ValueSliderFilter*>(filter));
+            break;
+        case FilterType::ExpandableFilterWidget:
+            visitor(static_cast<FilterGroupWidget*>(filter));
+            break;
+        default:
+            // this should never happen
+            qCritical() << "Unknown type of filter" << filter->filterId();
+            break;
+    }
+}
+
+struct FilterObjectFactory
+{
+    unity::scopes::FilterState::SPtr filterState;
+    Filters* parent;
+    QSharedPointer<unity::shell::scopes::FilterBaseInterface> filterObj;
+
+    void operator()(unity::scopes::OptionSelectorFilter::SCPtr const& filter)
+    {
+        filterObj.reset(new scopes_ng::OptionSelectorFilter(filter, filterState, parent));
+    }
+
+    void operator()(unity::scopes::RangeInputFilter::SCPtr const& filter)
+    {
+        filterObj.reset(new scopes_ng::RangeInputFilter(filter, filterState, parent));
+    }
+
+    void operator()(unity::scopes::ValueSliderFilter::SCPtr const& filter)
+    {
+        filterObj.reset(new scopes_ng::ValueSliderFilter(filter, filterState, parent));
+    }
+};
+
+struct UpdateInterfaceVisitor
+{
+    FilterUpdateInterface* shellFilter = nullptr;
+
+    template <typename FilterObject>
+    void operator()(FilterObject* filter)
+    {
+        shellFilter = filter;
+    }
+};
+
+FilterUpdateInterface* updateInterface(unity::shell::scopes::FilterBaseInterface* filter)
+{
+    UpdateInterfaceVisitor visitor;
+    visitFilter(filter, visitor);
+    return visitor.shellFilter;
+}
+
+}
+
 std::string FilterWrapper::id() const
 {
     if (isGroup()) {
@@ -57,6 +150,26 @@ bool FilterWrapper::isGroup() const
     return filters.size() > 1;
 }
 
+FilterUpdateInterface::FilterUpdateInterface()
+    : m_reportedActiveFiltersCount(0)
+{
+}
+
+void FilterUpdateInterface::refreshActiveFiltersCount()
+{
+    const int count = activeFiltersCount();
+    const int delta = count - m_reportedActiveFiltersCount;
+    if (delta != 0) {
+        m_reportedActiveFiltersCount = count;
+        emitActiveFiltersCountChanged(delta);
+    }
+}
+
+int FilterUpdateInterface::reportedActiveFiltersCount() const
+{
+    return m_reportedActiveFiltersCount;
+}
+
 void FilterUpdateInterface::update(FilterWrapper::SCPtr const& filterWrapper)
 {
     // The following is true for all individual filters, if this warning ever shows up, then it signifies a bug.
@@ -70,19 +183,23 @@ void FilterUpdateInterface::update(FilterWrapper::SCPtr const& filterWrapper)
 
 Filters::Filters(unity::scopes::FilterState const& filterState, QObject *parent) :
     ModelUpdate(parent),
-    m_filterState(new unity::scopes::FilterState(filterState))
+    m_filterState(new unity::scopes::FilterState(filterState)),
+    m_activeFiltersCount(0)
 {
     m_filterStateChangeTimer.setSingleShot(true);
     QObject::connect(&m_filterStateChangeTimer, &QTimer::timeout, this, &Filters::delayedFilterStateChange);
+    QObject::connect(this, &Filters::rowsAboutToBeRemoved, this, &Filters::onRowsAboutToBeRemoved);
 }
 
 
 Filters::Filters(unity::scopes::FilterState::SPtr const& filterState, QObject *parent) :
     ModelUpdate(parent),
-    m_filterState(filterState)
+    m_filterState(filterState),
+    m_activeFiltersCount(0)
 {
     m_filterStateChangeTimer.setSingleShot(true);
     QObject::connect(&m_filterStateChangeTimer, &QTimer::timeout, this, &Filters::delayedFilterStateChange);
+    QObject::connect(this, &Filters::rowsAboutToBeRemoved, this, &Filters::onRowsAboutToBeRemoved);
 }
 
 int Filters::rowCount(const QModelIndex&) const
@@ -121,6 +238,7 @@ void Filters::clear()
         m_filters.clear();
         m_filterState.reset(new unity::scopes::FilterState());
         endResetModel();
+        adjustActiveFiltersCount(-m_activeFiltersCount);
     }
 }
 
@@ -130,7 +248,7 @@ void Filters::reset()
     qDebug() << "Resetting filters to defaults";
     for (auto f: m_filters) {
         qDebug() << "Resetting filter:" << f->filterId();
-        auto shellFilter = dynamic_cast<FilterUpdateInterface*>(f.data());
+        auto shellFilter = updateInterface(f.data());
         Q_ASSERT(shellFilter);
         shellFilter->reset();
     }
@@ -147,24 +265,58 @@ void Filters::delayedFilterStateChange()
     Q_EMIT filterStateChanged();
 }
 
+void Filters::onActiveFiltersCountChanged(int delta)
+{
+    adjustActiveFiltersCount(delta);
+}
+
+void Filters::onRowsAboutToBeRemoved(const QModelIndex&, int first, int last)
+{
+    // removed filters no longer contribute to the number of active filters
+    int delta = 0;
+    for (int row = first; row <= last && row < m_filters.size(); row++) {
+        auto shellFilter = updateInterface(m_filters.at(row).data());
+        if (shellFilter) {
+            delta -= shellFilter->reportedActiveFiltersCount();
+        }
+    }
+    adjustActiveFiltersCount(delta);
+}
+
+void Filters::adjustActiveFiltersCount(int delta)
+{
+    if (delta != 0) {
+        m_activeFiltersCount += delta;
+        Q_EMIT activeFiltersCountChanged(delta);
+    }
+}
+
 QList<FilterWrapper::SCPtr> Filters::preprocessFilters(QList<unity::scopes::FilterBase::SCPtr> const &filters, bool processGroups)
 {
     QMap<std::string, FilterWrapper::SPtr> groups;
 
     QList<FilterWrapper::SCPtr> outFilters;
     for (auto const& filter: filters) {
+        const FilterType filterType = getFilterType(filter);
+        if (filterType == FilterType::Invalid) {
+            qWarning() << "Unsupported filter type:" << QString::fromStdString(filter->filter_type());
+            continue;
+        }
         FilterWrapper::SPtr wrapper;
         if (filter->filter_group() && processGroups) {
             auto it = groups.find(filter->filter_group()->id());
             if (it != groups.end()) {
                 wrapper = it.value();
+                wrapper->type = FilterType::ExpandableFilterWidget;
             } else {
                 wrapper = std::make_shared<FilterWrapper>();
+                wrapper->type = filterType;
                 outFilters.append(wrapper);
                 groups[filter->filter_group()->id()] = wrapper;
             }
         } else {
             wrapper = std::make_shared<FilterWrapper>();
+            wrapper->type = filterType;
             outFilters.append(wrapper);
         }
         wrapper->filters.append(filter);
@@ -180,25 +332,25 @@ void Filters::update(QList<unity::scopes::FilterBase::SCPtr> const& filters, boo
     for (auto f: filters) {
         // we can only have one primary filter. only a single-selection OptionSelectorFilter can be a primary nav.
         bool wantsToBePrimary = (f->display_hints() & unity::scopes::FilterBase::DisplayHints::Primary);
-        unity::scopes::OptionSelectorFilter::SCPtr optSelFilter = std::dynamic_pointer_cast<unity::scopes::OptionSelectorFilter const>(f);
-        if (optSelFilter == nullptr || optSelFilter->multi_select()) {
+        if (wantsToBePrimary && (getFilterType(f) != FilterType::OptionSelectorFilter ||
+                    std::static_pointer_cast<unity::scopes::OptionSelectorFilter const>(f)->multi_select())) {
             wantsToBePrimary = false;
         }
         if (wantsToBePrimary && !hasPrimaryFilter) {
             hasPrimaryFilter = true;
             //
-            const bool hadSamePrimaryFilterBefore = m_primaryFilter && (m_primaryFilter->filterId() == QString::fromStdString(f->id())) && (m_primaryFilter->filterType() == getFilterType(f));
+            const bool hadSamePrimaryFilterBefore = m_primaryFilter && (m_primaryFilter->filterId() == QString::fromStdString(f->id())) && (m_primaryFilter->filterType() == FilterType::OptionSelectorFilter);
             if (hadSamePrimaryFilterBefore) {
-                auto shellFilter = dynamic_cast<FilterUpdateInterface*>(m_primaryFilter.data());
+                auto shellFilter = updateInterface(m_primaryFilter.data());
                 if (shellFilter) {
                     shellFilter->update(f);
                 } else {
                     // this should never happen
-                    qCritical() << "Failed to cast filter" << m_primaryFilter->filterId() << "to FilterUpdateInterface";
+                    qCritical() << "Failed to get update interface of filter" << m_primaryFilter->filterId();
                 }
             } else {
                 // we didn't have primary filter before, or it changed substantially, so recreate it
-                m_primaryFilter = createFilterObject(f);
+                m_primaryFilter = createFilterObject(f, FilterType::OptionSelectorFilter);
                 Q_EMIT primaryFilterChanged();
             }
         } else {
@@ -221,21 +373,33 @@ void Filters::update(QList<unity::scopes::FilterBase::SCPtr> const& filters, boo
             [](const QSharedPointer<unity::shell::scopes::FilterBaseInterface>& f) -> QString { return f->filterId(); },
             // factory function
             [this](const FilterWrapper::SCPtr& f) -> QSharedPointer<unity::shell::scopes::FilterBaseInterface> {
-                return createFilterObject(f);
+                auto filterObj = createFilterObject(f);
+                auto shellFilter = updateInterface(filterObj.data());
+                if (shellFilter) {
+                    // only filters of this model are counted (i.e. not the primary filter)
+                    shellFilter->refreshActiveFiltersCount();
+                    connect(filterObj.data(), SIGNAL(activeFiltersCountChanged(int)), this, SLOT(onActiveFiltersCountChanged(int)));
+                    adjustActiveFiltersCount(shellFilter->reportedActiveFiltersCount());
+                }
+                return filterObj;
             },
             // filter update function
             [this](int, const FilterWrapper::SCPtr &f1, const QSharedPointer<unity::shell::scopes::FilterBaseInterface>& f2) -> bool {
                 qDebug() << "Updating filter" << f2->filterId();
-                if (f2->filterId() != QString::fromStdString(f1->id()) || f2->filterType() != getFilterType(f1))
+                auto shellFilter = updateInterface(f2.data());
+                if (f2->filterId() != QString::fromStdString(f1->id()) || f2->filterType() != f1->type)
                 {
+                    // filter is going to be re-created
+                    if (shellFilter) {
+                        adjustActiveFiltersCount(-shellFilter->reportedActiveFiltersCount());
+                    }
                     return false;
                 }
-                auto shellFilter = dynamic_cast<FilterUpdateInterface*>(f2.data());
                 if (shellFilter) {
                     shellFilter->update(f1);
                 } else {
                     // this should never happen
-                    qCritical() << "Failed to cast filter" << f2->filterId() << "to FilterUpdateInterface";
+                    qCritical() << "Failed to get update interface of filter" << f2->filterId();
                 }
                 return true;
             });
@@ -258,21 +422,21 @@ void Filters::update(unity::scopes::FilterState const& filterState)
 void Filters::updateForNewState()
 {
     if (m_primaryFilter) {
-        auto shellFilter = dynamic_cast<FilterUpdateInterface*>(m_primaryFilter.data());
+        auto shellFilter = updateInterface(m_primaryFilter.data());
         if (shellFilter) {
             shellFilter->update(m_filterState);
         } else {
             // this should never happen
-            qCritical() << "Failed to cast filter" << m_primaryFilter->filterId() << "to FilterUpdateInterface";
+            qCritical() << "Failed to get update interface of filter" << m_primaryFilter->filterId();
         }
     }
     for (auto f: m_filters) {
-        auto shellFilter = dynamic_cast<FilterUpdateInterface*>(f.data());
+        auto shellFilter = updateInterface(f.data());
         if (shellFilter) {
             shellFilter->update(m_filterState);
         } else {
             // this should never happen
-            qCritical() << "Failed to cast filter" << f->filterId() << "to FilterUpdateInterface";
+            qCritical() << "Failed to get update interface of filter" << f->filterId();
         }
     }
 }
@@ -286,72 +450,48 @@ QSharedPointer<unity::shell::scopes::FilterBaseInterface> Filters::createFilterO
         return groupObj;
     } else {
         auto filter = *(filterWrapper->filters.begin());
-        return createFilterObject(filter);
+        return createFilterObject(filter, filterWrapper->type);
     }
 }
 
-QSharedPointer<unity::shell::scopes::FilterBaseInterface> Filters::createFilterObject(unity::scopes::FilterBase::SCPtr const& filter)
+QSharedPointer<unity::shell::scopes::FilterBaseInterface> Filters::createFilterObject(unity::scopes::FilterBase::SCPtr const& filter, FilterType filterType)
 {
-    QSharedPointer<unity::shell::scopes::FilterBaseInterface> filterObj;
+    FilterObjectFactory factory { m_filterState, this, QSharedPointer<unity::shell::scopes::FilterBaseInterface>() };
+    visitFilter(filter, filterType, factory);
 
-    if (filter->filter_type() == "option_selector")
-    {
-        unity::scopes::OptionSelectorFilter::SCPtr optfilter = std::dynamic_pointer_cast<unity::scopes::OptionSelectorFilter const>(filter);
-        filterObj = QSharedPointer<unity::shell::scopes::FilterBaseInterface>(new scopes_ng::OptionSelectorFilter(optfilter, m_filterState, this));
-    }
-    else if (filter->filter_type() == "range_input")
-    {
-        unity::scopes::RangeInputFilter::SCPtr rangefilter = std::dynamic_pointer_cast<unity::scopes::RangeInputFilter const>(filter);
-        filterObj = QSharedPointer<unity::shell::scopes::FilterBaseInterface>(new scopes_ng::RangeInputFilter(rangefilter, m_filterState, this));
-    }
-    else if (filter->filter_type() == "value_slider")
-    {
-        unity::scopes::ValueSliderFilter::SCPtr valuesliderfilter = std::dynamic_pointer_cast<unity::scopes::ValueSliderFilter const>(filter);
-        filterObj = QSharedPointer<unity::shell::scopes::FilterBaseInterface>(new scopes_ng::ValueSliderFilter(valuesliderfilter, m_filterState, this));
-    }
-
-    // Warning!!! Make sure any new filter type created by this factory method is reflected below in getFilterType() method as well!
+    // Warning!!! Make sure any new filter type created by this factory method is reflected in getFilterType() and visitFilter() as well!
 
+    auto filterObj = factory.filterObj;
     if (filterObj)
     {
         QQmlEngine::setObjectOwnership(filterObj.data(), QQmlEngine::CppOwnership);
         connect(filterObj.data(), SIGNAL(filterStateChanged()), this, SLOT(onFilterStateChanged()));
     }
-    else
-    {
-        qWarning() << "Unsupported filter type:" << QString::fromStdString(filter->filter_type());
-    }
 
     return filterObj;
 }
 
 unity::shell::scopes::FiltersInterface::FilterType Filters::getFilterType(unity::scopes::FilterBase::SCPtr const& filter)
 {
-    // WARNING! Some filters may rely on inheritance, in that case the dynamic casts below need to be in correct order
-    // (e.g. more concrete types first, base/generic types last).
-    if (std::dynamic_pointer_cast<unity::scopes::OptionSelectorFilter const>(filter))
+    const std::string filterType = filter->filter_type();
+    if (filterType == "option_selector")
     {
         return unity::shell::scopes::FiltersInterface::FilterType::OptionSelectorFilter;
     }
-    if (std::dynamic_pointer_cast<unity::scopes::RangeInputFilter const>(filter))
+    if (filterType == "range_input")
     {
         return unity::shell::scopes::FiltersInterface::FilterType::RangeInputFilter;
     }
-    if (std::dynamic_pointer_cast<unity::scopes::ValueSliderFilter const>(filter))
+    if (filterType == "value_slider")
     {
         return unity::shell::scopes::FiltersInterface::FilterType::ValueSliderFilter;
     }
-    qFatal("getFilterType(): Unknown filter type: %s\n", filter->filter_type().c_str());
     return unity::shell::scopes::FiltersInterface::FilterType::Invalid;
 }
 
 unity::shell::scopes::FiltersInterface::FilterType Filters::getFilterType(FilterWrapper::SCPtr const& filterWrapper)
 {
-    if (filterWrapper->isGroup()) {
-        return unity::shell::scopes::FiltersInterface::FilterType::ExpandableFilterWidget;
-    }
-    auto filter = *(filterWrapper->filters.begin());
-    return getFilterType(filter);
+    return filterWrapper->type;
 }
 
 unity::scopes::FilterState Filters::filterState() const
@@ -369,16 +509,7 @@ QSharedPointer<unity::shell::scopes::FilterBaseInterface> Filters::primaryFilter
 
 int Filters::activeFiltersCount() const
 {
-    int count = 0;
-    for (auto filter: m_filters) {
-        auto shellFilter = dynamic_cast<FilterUpdateInterface*>(filter.data());
-        auto const delta = shellFilter->activeFiltersCount();
-        if (delta > 0) {
-            qDebug() << "activeFiltersCount: filter" << filter->filterId() << "is active";
-            count += delta;
-        }
-    }
-    return count;
+    return m_activeFiltersCount;
 }
 
 }
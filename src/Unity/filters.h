@@ -39,6 +39,8 @@ struct FilterWrapper
     UNITY_DEFINES_PTRS(FilterWrapper);
 
     QList<unity::scopes::FilterBase::SCPtr> filters;
+    // type of the shell filter object for this wrapper, determined once when filters are received
+    unity::shell::scopes::FiltersInterface::FilterType type = unity::shell::scopes::FiltersInterface::FilterType::Invalid;
     std::string id() const;
     bool isGroup() const;
 };
@@ -46,6 +48,8 @@ struct FilterWrapper
 class FilterUpdateInterface
 {
     public:
+        FilterUpdateInterface();
+
         // Apply potential updates of filter definition coming from scope.
         virtual void update(unity::scopes::FilterBase::SCPtr const& filter) = 0;
         virtual void update(FilterWrapper::SCPtr const& filterWrapper);
@@ -56,10 +60,24 @@ class FilterUpdateInterface
         // Check if the filter (or group of filters represented by this filter) is active (i.e. greater than 0)
         virtual int activeFiltersCount() const = 0;
 
+        // Re-evaluate activeFiltersCount() and report the difference since the last report (if any) via activeFiltersCountChanged(int) signal.
+        // Filters need to call this whenever their state may have changed.
+        void refreshActiveFiltersCount();
+
+        // The number of active filters as last reported.
+        int reportedActiveFiltersCount() const;
+
         // Reset filter to defaults.
         virtual void reset() = 0;
 
         virtual ~FilterUpdateInterface() {}
+
+    protected:
+        // Emit activeFiltersCountChanged(int) signal of the filter object.
+        virtual void emitActiveFiltersCountChanged(int delta) = 0;
+
+    private:
+        int m_reportedActiveFiltersCount;
 };
 
 class Q_DECL_EXPORT Filters :
@@ -89,23 +107,29 @@ public Q_SLOTS:
 private Q_SLOTS:
     void onFilterStateChanged();
     void delayedFilterStateChange();
+    void onActiveFiltersCountChanged(int delta);
+    void onRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
 
 Q_SIGNALS:
     void filterStateChanged();
     void primaryFilterChanged();
+    void activeFiltersCountChanged(int delta);
 
 private:
     void updateForNewState();
+    void adjustActiveFiltersCount(int delta);
 
     static QList<FilterWrapper::SCPtr> preprocessFilters(QList<unity::scopes::FilterBase::SCPtr> const &filters, bool processGroups);
     static unity::shell::scopes::FiltersInterface::FilterType getFilterType(FilterWrapper::SCPtr const& filterWrapper);
     static unity::shell::scopes::FiltersInterface::FilterType getFilterType(unity::scopes::FilterBase::SCPtr const& filter);
-    QSharedPointer<unity::shell::scopes::FilterBaseInterface> createFilterObject(unity::scopes::FilterBase::SCPtr const& filter);
+    QSharedPointer<unity::shell::scopes::FilterBaseInterface> createFilterObject(unity::scopes::FilterBase::SCPtr const& filter,
+            unity::shell::scopes::FiltersInterface::FilterType filterType);
     QSharedPointer<unity::shell::scopes::FilterBaseInterface> createFilterObject(FilterWrapper::SCPtr const& filterWrapper);
     QList<QSharedPointer<unity::shell::scopes::FilterBaseInterface>> m_filters;
     QSharedPointer<unity::shell::scopes::FilterBaseInterface> m_primaryFilter;
     unity::scopes::FilterState::SPtr m_filterState;
     QTimer m_filterStateChangeTimer;
+    int m_activeFiltersCount;
 };
 
 } // namespace scopes_ng
@@ -19,11 +19,129 @@
 
 #include "geoip.h"
 
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QNetworkReply>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QXmlStreamReader>
 
 using namespace scopes_ng;
 
+namespace
+{
+
+static const quint32 CACHE_MAGIC = 0x55534749; // "USGI"
+
+static const quint32 CACHE_VERSION = 1;
+
+}
+
+bool GeoIp::Result::operator==(const Result& other) const
+{
+    return valid == other.valid && ip == other.ip && status == other.status
+            && countryCode == other.countryCode && countryCode3 == other.countryCode3
+            && countryName == other.countryName && regionCode == other.regionCode
+            && regionName == other.regionName && city == other.city
+            && zipPostalCode == other.zipPostalCode && latitude == other.latitude
+            && longitude == other.longitude && areaCode == other.areaCode
+            && timeZone == other.timeZone;
+}
+
+QUrl GeoIp::defaultUrl()
+{
+    if (qEnvironmentVariableIsSet("UNITY_SCOPES_GEOIP_URL"))
+    {
+        return QUrl(QString::fromUtf8(qgetenv("UNITY_SCOPES_GEOIP_URL")));
+    }
+    return QUrl(QStringLiteral("http://geoip.ubuntu.com/lookup"));
+}
+
+QString GeoIp::defaultCachePath()
+{
+    if (qEnvironmentVariableIsSet("UNITY_SCOPES_GEOIP_CACHE"))
+    {
+        return QString::fromLocal8Bit(qgetenv("UNITY_SCOPES_GEOIP_CACHE"));
+    }
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (cacheDir.isEmpty())
+    {
+        return QString();
+    }
+    return QDir(cacheDir).filePath(QStringLiteral("unity-scopes/geoip.cache"));
+}
+
+bool GeoIp::saveCache(const QString& path, const Result& result, const QDateTime& timestamp)
+{
+    if (path.isEmpty() || !result.valid)
+    {
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Cannot open GeoIP cache" << path << "for writing:" << file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << CACHE_MAGIC << CACHE_VERSION << timestamp.toUTC()
+           << result.ip << result.status << result.countryCode << result.countryCode3
+           << result.countryName << result.regionCode << result.regionName << result.city
+           << result.zipPostalCode << result.latitude << result.longitude << result.areaCode
+           << result.timeZone;
+
+    if (!file.commit())
+    {
+        qWarning() << "Failed to write GeoIP cache" << path << ":" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool GeoIp::loadCache(const QString& path, Result& result, QDateTime& timestamp)
+{
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0, version = 0;
+    stream >> magic >> version;
+    if (stream.status() != QDataStream::Ok || magic != CACHE_MAGIC || version != CACHE_VERSION)
+    {
+        qWarning() << "Ignoring invalid GeoIP cache" << path;
+        return false;
+    }
+
+    Result cached;
+    QDateTime cachedTimestamp;
+    stream >> cachedTimestamp
+           >> cached.ip >> cached.status >> cached.countryCode >> cached.countryCode3
+           >> cached.countryName >> cached.regionCode >> cached.regionName >> cached.city
+           >> cached.zipPostalCode >> cached.latitude >> cached.longitude >> cached.areaCode
+           >> cached.timeZone;
+    if (stream.status() != QDataStream::Ok || !cachedTimestamp.isValid())
+    {
+        qWarning() << "Ignoring invalid GeoIP cache" << path;
+        return false;
+    }
+
+    cached.valid = true;
+    result = cached;
+    timestamp = cachedTimestamp;
+    return true;
+}
+
 GeoIp::GeoIp(const QUrl& url) :
         m_url(url)
 {
@@ -20,6 +20,7 @@
 #ifndef GEOIP_H
 #define GEOIP_H
 
+#include <QDateTime>
 #include <QNetworkAccessManager>
 #include <QUrl>
 
@@ -65,16 +66,28 @@ public:
         QString areaCode;
 
         QString timeZone;
+
+        bool operator==(const Result& other) const;
     };
 
     typedef QSharedPointer<GeoIp> Ptr;
 
-    GeoIp(const QUrl& url = QUrl(QStringLiteral("http://geoip.ubuntu.com/lookup")));
+    // Lookup service URL, can be overridden with UNITY_SCOPES_GEOIP_URL (e.g. to use a local stand-in)
+    static QUrl defaultUrl();
+
+    GeoIp(const QUrl& url = defaultUrl());
 
     ~GeoIp() = default;
 
     void whollyMoveThread(QThread *thread);
 
+    // The result of the last successful lookup is persisted, so that it's available right away on startup
+    static QString defaultCachePath();
+
+    static bool saveCache(const QString& path, const Result& result, const QDateTime& timestamp);
+
+    static bool loadCache(const QString& path, Result& result, QDateTime& timestamp);
+
 public Q_SLOTS:
     void start();
 
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// self
+#include "lazyvariant.h"
+
+// local
+#include "utils.h"
+
+#include <QQmlEngine>
+
+namespace scopes_ng
+{
+
+using namespace unity;
+
+LazyVariant::LazyVariant(std::shared_ptr<const scopes::Variant> const& variant, QObject* parent)
+    : QObject(parent)
+    , m_variant(variant)
+{
+}
+
+bool LazyVariant::enabled()
+{
+    return qEnvironmentVariableIsSet("UNITY_SCOPES_LAZY_VARIANTS");
+}
+
+QVariant LazyVariant::fromScopeVariant(std::shared_ptr<const scopes::Variant> const& variant, QObject* parent)
+{
+    if (!variant) {
+        return QVariant();
+    }
+    if (variant->which() != scopes::Variant::Type::Dict && variant->which() != scopes::Variant::Type::Array) {
+        return scopeVariantToQVariant(*variant);
+    }
+
+    LazyVariant* wrapper = new LazyVariant(variant, parent);
+    QQmlEngine::setObjectOwnership(wrapper, parent ? QQmlEngine::CppOwnership : QQmlEngine::JavaScriptOwnership);
+    return QVariant::fromValue(wrapper);
+}
+
+QVariant LazyVariant::toQVariant(QVariant const& variant)
+{
+    if (variant.userType() == qMetaTypeId<LazyVariant*>()) {
+        LazyVariant* wrapper = variant.value<LazyVariant*>();
+        if (wrapper) {
+            return wrapper->toVariant();
+        }
+    }
+    return variant;
+}
+
+scopes::Variant const& LazyVariant::scopeVariant() const
+{
+    return *m_variant;
+}
+
+bool LazyVariant::isDict() const
+{
+    return m_variant->which() == scopes::Variant::Type::Dict;
+}
+
+bool LazyVariant::isArray() const
+{
+    return m_variant->which() == scopes::Variant::Type::Array;
+}
+
+int LazyVariant::count() const
+{
+    if (isDict()) {
+        return static_cast<int>(dict().size());
+    }
+    if (isArray()) {
+        return static_cast<int>(array().size());
+    }
+    return 0;
+}
+
+QStringList LazyVariant::keys() const
+{
+    QStringList result;
+    if (isDict()) {
+        auto const& d = dict();
+        result.reserve(static_cast<int>(d.size()));
+        for (auto const& kv: d) {
+            result.append(QString::fromStdString(kv.first));
+        }
+    }
+    return result;
+}
+
+bool LazyVariant::contains(QString const& key) const
+{
+    return isDict() && dict().find(key.toStdString()) != dict().end();
+}
+
+QVariant LazyVariant::value(QString const& key) const
+{
+    if (!isDict()) {
+        return QVariant();
+    }
+    auto const& d = dict();
+    auto it = d.find(key.toStdString());
+    if (it == d.end()) {
+        return QVariant();
+    }
+    // alias into the cached container, which keeps it alive for as long as the child needs it
+    return fromScopeVariant(std::shared_ptr<const scopes::Variant>(m_dict, &it->second));
+}
+
+QVariant LazyVariant::at(int index) const
+{
+    if (!isArray() || index < 0 || index >= static_cast<int>(array().size())) {
+        return QVariant();
+    }
+    return fromScopeVariant(std::shared_ptr<const scopes::Variant>(m_array, &array()[index]));
+}
+
+QVariant LazyVariant::toVariant() const
+{
+    return scopeVariantToQVariant(*m_variant);
+}
+
+scopes::VariantMap const& LazyVariant::dict() const
+{
+    if (!m_dict) {
+        m_dict = std::make_shared<const scopes::VariantMap>(m_variant->get_dict());
+    }
+    return *m_dict;
+}
+
+scopes::VariantArray const& LazyVariant::array() const
+{
+    if (!m_array) {
+        m_array = std::make_shared<const scopes::VariantArray>(m_variant->get_array());
+    }
+    return *m_array;
+}
+
+} // namespace scopes_ng
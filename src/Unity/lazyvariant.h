@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NG_LAZY_VARIANT_H
+#define NG_LAZY_VARIANT_H
+
+#include <QObject>
+#include <QStringList>
+#include <QVariant>
+
+#include <unity/scopes/Variant.h>
+
+#include <memory>
+
+namespace scopes_ng
+{
+
+/**
+  Read-only QML view of a dict or array scopes::Variant. Values are only converted to
+  QVariants when accessed; nested dicts and arrays are handed out as further LazyVariants.
+  The original variant is shared rather than copied, so the owner (e.g. a result) can be
+  kept alive with an aliasing shared_ptr.
+*/
+class Q_DECL_EXPORT LazyVariant : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool isDict READ isDict CONSTANT)
+    Q_PROPERTY(bool isArray READ isArray CONSTANT)
+    Q_PROPERTY(int count READ count CONSTANT)
+    Q_PROPERTY(QStringList keys READ keys CONSTANT)
+
+public:
+    explicit LazyVariant(std::shared_ptr<const unity::scopes::Variant> const& variant, QObject* parent = nullptr);
+
+    // Whether large values should be exposed lazily; controlled by UNITY_SCOPES_LAZY_VARIANTS.
+    static bool enabled();
+
+    // Wraps dicts and arrays in a LazyVariant, converts all other types right away.
+    // Without a parent the wrapper is owned by the QML engine.
+    static QVariant fromScopeVariant(std::shared_ptr<const unity::scopes::Variant> const& variant, QObject* parent = nullptr);
+
+    // Returns the fully converted value if 'variant' holds a LazyVariant, 'variant' otherwise.
+    static QVariant toQVariant(QVariant const& variant);
+
+    // The wrapped value, e.g. to check whether a wrapper can be reused.
+    unity::scopes::Variant const& scopeVariant() const;
+
+    bool isDict() const;
+    bool isArray() const;
+    int count() const;
+    QStringList keys() const;
+
+    Q_INVOKABLE bool contains(QString const& key) const;
+    Q_INVOKABLE QVariant value(QString const& key) const;
+    Q_INVOKABLE QVariant at(int index) const;
+    Q_INVOKABLE QVariant toVariant() const;
+
+private:
+    unity::scopes::VariantMap const& dict() const;
+    unity::scopes::VariantArray const& array() const;
+
+    std::shared_ptr<const unity::scopes::Variant> m_variant;
+    // scopes::Variant hands out copies of its containers; keep them so that children can point into them
+    mutable std::shared_ptr<const unity::scopes::VariantMap> m_dict;
+    mutable std::shared_ptr<const unity::scopes::VariantArray> m_array;
+};
+
+} // namespace scopes_ng
+
+Q_DECLARE_METATYPE(scopes_ng::LazyVariant*)
+
+#endif
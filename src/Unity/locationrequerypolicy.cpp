@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "locationrequerypolicy.h"
+
+namespace scopes_ng
+{
+
+LocationRequeryPolicy::LocationRequeryPolicy(double distanceThreshold, double noiseThreshold, qint64 requeryInterval)
+    : m_distanceThreshold(distanceThreshold)
+    , m_noiseThreshold(noiseThreshold)
+    , m_requeryInterval(requeryInterval)
+    , m_referenceTimestamp(0)
+{
+}
+
+bool LocationRequeryPolicy::update(QGeoCoordinate const& position, qint64 timestamp)
+{
+    if (!position.isValid()) {
+        return false;
+    }
+
+    // the first fix is always better than what the searches had so far
+    if (!m_reference.isValid()) {
+        setReference(position, timestamp);
+        return true;
+    }
+
+    const double distance = m_reference.distanceTo(position);
+    const bool moved = distance > m_distanceThreshold;
+    const bool expired = timestamp - m_referenceTimestamp >= m_requeryInterval && distance > m_noiseThreshold;
+    if (moved || expired) {
+        setReference(position, timestamp);
+        return true;
+    }
+    return false;
+}
+
+void LocationRequeryPolicy::setReference(QGeoCoordinate const& position, qint64 timestamp)
+{
+    m_reference = position;
+    m_referenceTimestamp = timestamp;
+}
+
+QGeoCoordinate LocationRequeryPolicy::reference() const
+{
+    return m_reference;
+}
+
+} // namespace scopes_ng
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NG_LOCATION_REQUERY_POLICY_H
+#define NG_LOCATION_REQUERY_POLICY_H
+
+#include <QGeoCoordinate>
+
+namespace scopes_ng
+{
+
+/**
+  Decides whether a location update is significant enough to re-run searches of
+  location-aware scopes: the position has to move by more than the distance threshold,
+  or by more than the noise threshold once the requery interval has passed since the last requery.
+*/
+class Q_DECL_EXPORT LocationRequeryPolicy
+{
+public:
+    // distances in metres, interval in ms
+    LocationRequeryPolicy(double distanceThreshold, double noiseThreshold, qint64 requeryInterval);
+
+    // Returns true if searches should be re-run for the new position; the position then becomes
+    // the reference for subsequent updates.
+    bool update(QGeoCoordinate const& position, qint64 timestamp);
+
+    // Sets the reference position without requesting a requery, e.g. the location the current
+    // results were obtained for.
+    void setReference(QGeoCoordinate const& position, qint64 timestamp);
+
+    QGeoCoordinate reference() const;
+
+private:
+    double m_distanceThreshold;
+    double m_noiseThreshold;
+    qint64 m_requeryInterval;
+    QGeoCoordinate m_reference;
+    qint64 m_referenceTimestamp;
+};
+
+} // namespace scopes_ng
+
+#endif
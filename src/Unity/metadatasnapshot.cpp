@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Self
+#include "metadatasnapshot.h"
+
+// local
+#include "utils.h"
+
+// Qt
+#include <QByteArray>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace scopes_ng
+{
+
+using namespace unity;
+
+namespace
+{
+
+const quint32 SNAPSHOT_MAGIC = 0x55534d53; // "USMS"
+const quint32 SNAPSHOT_VERSION = 1;
+
+// ScopeMetadata getters of optional attributes throw if the attribute is not set
+template <typename Getter>
+QString optionalAttribute(Getter getter)
+{
+    try {
+        return QString::fromStdString(getter());
+    } catch (...) {
+        return QString();
+    }
+}
+
+}
+
+ScopeSnapshot ScopeSnapshot::fromMetadata(scopes::ScopeMetadata const& metadata)
+{
+    ScopeSnapshot snapshot;
+    snapshot.id = QString::fromStdString(metadata.scope_id());
+    snapshot.name = QString::fromStdString(metadata.display_name());
+    snapshot.description = QString::fromStdString(metadata.description());
+    snapshot.icon = optionalAttribute([&metadata]() { return metadata.icon(); });
+    snapshot.searchHint = optionalAttribute([&metadata]() { return metadata.search_hint(); });
+    snapshot.shortcut = optionalAttribute([&metadata]() { return metadata.hot_key(); });
+    snapshot.customizations = scopeVariantToQVariant(scopes::Variant(metadata.appearance_attributes())).toMap();
+    snapshot.invisible = metadata.invisible();
+    return snapshot;
+}
+
+QString MetadataSnapshot::defaultPath()
+{
+    if (qEnvironmentVariableIsSet("UNITY_SCOPES_METADATA_SNAPSHOT")) {
+        return QString::fromLocal8Bit(qgetenv("UNITY_SCOPES_METADATA_SNAPSHOT"));
+    }
+    // custom runtime configs point to a different registry; don't mix it up with the system one
+    if (!qgetenv("UNITY_SCOPES_RUNTIME_PATH").isEmpty()) {
+        return QString();
+    }
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (cacheDir.isEmpty()) {
+        return QString();
+    }
+    return QDir(cacheDir).filePath(QStringLiteral("unity-scopes/metadata.snapshot"));
+}
+
+bool MetadataSnapshot::save(QString const& path, scopes::MetadataMap const& metadata)
+{
+    QMap<QString, ScopeSnapshot> scopes;
+    for (auto it = metadata.begin(); it != metadata.end(); ++it) {
+        scopes.insert(QString::fromStdString(it->first), ScopeSnapshot::fromMetadata(it->second));
+    }
+    return save(path, scopes);
+}
+
+bool MetadataSnapshot::save(QString const& path, QMap<QString, ScopeSnapshot> const& scopes)
+{
+    QByteArray data;
+    {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << SNAPSHOT_MAGIC << SNAPSHOT_VERSION << static_cast<quint32>(scopes.size());
+        for (auto const& scope: scopes) {
+            stream << scope.id << scope.name << scope.description << scope.icon << scope.searchHint
+                   << scope.shortcut << scope.customizations << scope.invisible;
+        }
+    }
+
+    // skip rewriting the file if nothing changed since the last listing
+    QFile current(path);
+    if (current.size() == data.size() && current.open(QIODevice::ReadOnly) && current.readAll() == data) {
+        return true;
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot open metadata snapshot" << path << "for writing:" << file.errorString();
+        return false;
+    }
+    file.write(data);
+    if (!file.commit()) {
+        qWarning() << "Failed to write metadata snapshot" << path << ":" << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+QMap<QString, ScopeSnapshot> MetadataSnapshot::load(QString const& path)
+{
+    QMap<QString, ScopeSnapshot> scopes;
+
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return scopes;
+    }
+
+    const qint64 size = file.size();
+    uchar* mapped = size > 0 ? file.map(0, size) : nullptr;
+    if (mapped == nullptr) {
+        return scopes;
+    }
+
+    {
+        const QByteArray data(QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), static_cast<int>(size)));
+        QDataStream stream(data);
+        stream.setVersion(QDataStream::Qt_5_0);
+
+        quint32 magic = 0, version = 0, count = 0;
+        stream >> magic >> version >> count;
+        if (stream.status() == QDataStream::Ok && magic == SNAPSHOT_MAGIC && version == SNAPSHOT_VERSION) {
+            for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+                ScopeSnapshot scope;
+                stream >> scope.id >> scope.name >> scope.description >> scope.icon >> scope.searchHint
+                       >> scope.shortcut >> scope.customizations >> scope.invisible;
+                scopes.insert(scope.id, scope);
+            }
+        }
+        if (stream.status() != QDataStream::Ok || magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION) {
+            qWarning() << "Ignoring invalid metadata snapshot" << path;
+            scopes.clear();
+        }
+    }
+
+    file.unmap(mapped);
+    return scopes;
+}
+
+} // namespace scopes_ng
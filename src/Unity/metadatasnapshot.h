@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NG_METADATA_SNAPSHOT_H
+#define NG_METADATA_SNAPSHOT_H
+
+#include <QMap>
+#include <QString>
+#include <QVariantMap>
+
+#include <unity/scopes/Registry.h>
+#include <unity/scopes/ScopeMetadata.h>
+
+namespace scopes_ng
+{
+
+/**
+  Display data of a single scope, as recorded by the last registry listing.
+*/
+struct ScopeSnapshot
+{
+    QString id;
+    QString name;
+    QString description;
+    QString icon;
+    QString searchHint;
+    QString shortcut;
+    QVariantMap customizations;
+    bool invisible = false;
+
+    static ScopeSnapshot fromMetadata(unity::scopes::ScopeMetadata const& metadata);
+};
+
+/**
+  On-disk snapshot of the scope registry, used to populate the dash
+  before the registry answers the (slow) list() call.
+*/
+class Q_DECL_EXPORT MetadataSnapshot
+{
+public:
+    // path of the snapshot file; empty if snapshots are disabled
+    static QString defaultPath();
+
+    static bool save(QString const& path, unity::scopes::MetadataMap const& metadata);
+    static bool save(QString const& path, QMap<QString, ScopeSnapshot> const& scopes);
+    // returns an empty map if the file doesn't exist or is not a valid snapshot
+    static QMap<QString, ScopeSnapshot> load(QString const& path);
+};
+
+} // namespace scopes_ng
+
+#endif
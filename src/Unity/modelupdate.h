@@ -20,20 +20,28 @@
 #ifndef NG_MODEL_UPDATE_H
 #define NG_MODEL_UPDATE_H
 
+#include <QHash>
+#include <QModelIndex>
 #include <QSet>
-#include <functional>
+#include <QVector>
+
+#include <algorithm>
+#include <vector>
 
 template <class ModelBase, class InputContainer, class OutputContainer, class KeyType=QString>
 class ModelUpdate: public ModelBase
 {
 public:
-    using InputKeyFunc = std::function<KeyType(typename InputContainer::value_type)>;
-    using OutputKeyFunc = std::function<KeyType(typename OutputContainer::value_type)>;
-    using CreateFunc = std::function<typename OutputContainer::value_type(typename InputContainer::value_type const&)>;
-    using UpdateFunc = std::function<bool(int, typename InputContainer::value_type const&, typename OutputContainer::value_type const&)>;
-
     ModelUpdate(QObject *parent = nullptr): ModelBase(parent) {}
 
+    // Synchronize model with input, emitting a minimal set of model signals.
+    // The callables are template parameters so that they can be inlined; they are expected to have the following signatures:
+    //   KeyType inKeyFunc(InputContainer::value_type const&)
+    //   KeyType outKeyFunc(OutputContainer::value_type const&)
+    //   OutputContainer::value_type createFunc(InputContainer::value_type const&)
+    //   bool updateFunc(int row, InputContainer::value_type const&, OutputContainer::value_type const&)
+    // Input items with duplicate keys are only considered once (first occurrence wins).
+    template <typename InputKeyFunc, typename OutputKeyFunc, typename CreateFunc, typename UpdateFunc>
     void syncModel(InputContainer const& input,
             OutputContainer &model,
             const InputKeyFunc& inKeyFunc,
@@ -41,102 +49,253 @@ public:
             const CreateFunc& createFunc,
             const UpdateFunc& updateFunc)
     {
-        QMap<KeyType, int> newItems; // lookup for recevied objects and their desired rows in the model
+        const int inputSize = static_cast<int>(input.size());
+
+        QHash<KeyType, int> newItems; // lookup for received objects; maps to input position first, then to the desired row in the model
         QSet<KeyType> oldItems; // lookup for objects that were already displayed
+        newItems.reserve(inputSize);
+        oldItems.reserve(model.size());
 
         {
             int pos = 0;
-            for (auto item: input)
+            for (auto const& item: input)
             {
-                newItems[inKeyFunc(item)] = pos++;
+                const KeyType id = inKeyFunc(item);
+                if (!newItems.contains(id))
+                {
+                    newItems.insert(id, pos);
+                }
+                ++pos;
             }
         }
 
-        // iterate over old objects, remove objects that are not present anymore
+        // iterate over old objects, remove objects that are not present anymore (one signal per contiguous range of rows)
         {
             int row = 0;
-            for (auto it = model.begin(); it != model.end();)
+            while (row < model.size())
             {
-                const KeyType id = outKeyFunc(*it);
-                if (!newItems.contains(id))
-                {
-                    this->beginRemoveRows(QModelIndex(), row, row);
-                    it = model.erase(it);
-                    this->endRemoveRows();
-                }
-                else
+                const KeyType id = outKeyFunc(model.at(row));
+                if (newItems.contains(id))
                 {
                     oldItems.insert(id);
-                    ++it;
                     ++row;
+                    continue;
+                }
+                int last = row + 1;
+                while (last < model.size() && !newItems.contains(outKeyFunc(model.at(last))))
+                {
+                    ++last;
                 }
+                this->beginRemoveRows(QModelIndex(), row, last - 1);
+                model.erase(model.begin() + row, model.begin() + last);
+                this->endRemoveRows();
             }
         }
 
-        // iterate over new objects and insert them in the model
+        // iterate over new objects and insert them in the model (one signal per contiguous range of rows);
+        // record the desired row of every object for the move phase.
+        QVector<bool> inModel(inputSize, false);
         {
             int row = 0;
+            int pos = 0;
+            OutputContainer batch;
+
+            auto const flushBatch = [this, &model, &batch, &row]() {
+                if (!batch.isEmpty())
+                {
+                    const int first = row - batch.size();
+                    this->beginInsertRows(QModelIndex(), first, row - 1);
+                    for (int i = 0; i < batch.size(); i++)
+                    {
+                        model.insert(first + i, batch.at(i));
+                    }
+                    this->endInsertRows();
+                    batch.clear();
+                }
+            };
+
             for (auto const& item: input)
             {
-                if (!oldItems.contains(inKeyFunc(item)))
+                const KeyType id = inKeyFunc(item);
+                auto it = newItems.find(id);
+                // desired rows never exceed input positions, so this only skips duplicates
+                if (it.value() != pos)
+                {
+                    ++pos;
+                    continue;
+                }
+                if (oldItems.contains(id))
+                {
+                    flushBatch();
+                }
+                else
                 {
                     auto obj = createFunc(item);
-                    if (obj)
+                    if (!obj)
                     {
-                        this->beginInsertRows(QModelIndex(), row, row);
-                        model.insert(row, obj);
-                        this->endInsertRows();
+                        ++pos;
+                        continue;
                     }
+                    batch.append(obj);
                 }
-                row++;
+                it.value() = row++;
+                inModel[pos++] = true;
             }
+            flushBatch();
         }
 
-        // move objects if position changed
-        for (int i = 0; i<model.size(); )
+        // move objects if position changed; objects forming the longest increasing subsequence of desired rows
+        // keep their relative order, so only the remaining objects need to be moved.
         {
-            auto const id = outKeyFunc(model[i]);
-            int pos = newItems.value(id, -1);
-            if (pos >= 0 && pos != i) {
-                this->beginMoveRows(QModelIndex(), i, i, QModelIndex(), pos + (pos > i ? 1 : 0));
-                model.move(i, pos);
-                this->endMoveRows();
-                continue;
+            std::vector<int> targets;
+            targets.reserve(model.size());
+            for (auto const& obj: model)
+            {
+                targets.push_back(newItems.value(outKeyFunc(obj)));
             }
-            i++;
-        }
 
-        // check if any of the existing objects which didn't change position needs updating
-        /*{
-            int row = 0;
-            for (auto const& in: input)
+            const std::vector<bool> stable = longestIncreasingSubsequence(targets);
+            std::vector<int> pending;
+            for (size_t i = 0; i < targets.size(); i++)
             {
-                if (oldItems.contains(inKeyFunc(in)))
+                if (!stable[i])
                 {
-                    if (!updateFunc(in, model[row]))
-                    {
-                        model[row] = createFunc(in);
-                        Q_EMIT this->dataChanged(this->index(row, 0), this->index(row, 0)); // or beginRemoveRows & beginInsertRows ?
-                    }
+                    pending.push_back(targets[i]);
+                }
+            }
+            std::sort(pending.begin(), pending.end());
+
+            // place every pending object right after its predecessor, which is already in its final relative position.
+            // Slot 0 stands for the top of the model and slot i+1 for the original row i; a slot holds the object
+            // originally in that row (until it is moved) followed by the objects moved right after it, so current rows
+            // are prefix sums over slots.
+            const int count = static_cast<int>(targets.size());
+            RowCounter rows(count + 1);
+            std::vector<int> slotOf(count); // desired row -> slot holding the object
+            std::vector<bool> inSlot(count + 1, false); // whether the object originally in the slot's row is still there
+            std::vector<int> movedAfter(count + 1, 0); // number of objects moved right after the slot's object
+            for (int i = 0; i < count; i++)
+            {
+                rows.add(i + 1, 1);
+                inSlot[i + 1] = true;
+                slotOf[targets[i]] = i + 1;
+            }
+
+            for (int target: pending)
+            {
+                const int slot = slotOf[target];
+                const int from = rows.prefix(slot);
+                rows.add(slot, -1);
+                inSlot[slot] = false;
+
+                // the predecessor is either in its original row or the last object moved after that row
+                const int anchor = (target > 0) ? slotOf[target - 1] : 0;
+                const int to = rows.prefix(anchor) + (inSlot[anchor] ? 1 : 0) + movedAfter[anchor];
+                rows.add(anchor, 1);
+                ++movedAfter[anchor];
+                slotOf[target] = anchor;
+
+                if (from != to)
+                {
+                    this->beginMoveRows(QModelIndex(), from, from, QModelIndex(), to + (to > from ? 1 : 0));
+                    model.move(from, to);
+                    this->endMoveRows();
                 }
-                ++row;
             }
-        }*/
+        }
 
-        // call updateFunc for all objects to synchornize changes to properties
+        // call updateFunc for all objects to synchronize changes to properties; objects which can't be updated
+        // are re-created (one dataChanged signal per contiguous range of rows).
         {
             int row = 0;
+            int pos = 0;
+            int changedFirst = -1;
             for (auto const& in: input)
             {
+                if (!inModel[pos++])
+                {
+                    continue;
+                }
                 if (!updateFunc(row, in, model[row]))
                 {
                     model[row] = createFunc(in);
-                    Q_EMIT this->dataChanged(this->index(row, 0), this->index(row, 0)); // or beginRemoveRows & beginInsertRows ?
+                    if (changedFirst < 0)
+                    {
+                        changedFirst = row;
+                    }
+                }
+                else if (changedFirst >= 0)
+                {
+                    Q_EMIT this->dataChanged(this->index(changedFirst, 0), this->index(row - 1, 0));
+                    changedFirst = -1;
                 }
                 ++row;
             }
+            if (changedFirst >= 0)
+            {
+                Q_EMIT this->dataChanged(this->index(changedFirst, 0), this->index(row - 1, 0));
+            }
         }
+    }
+
+private:
+    // Fenwick tree of row counts; both operations are O(log n).
+    class RowCounter
+    {
+    public:
+        explicit RowCounter(int size): m_tree(size + 1, 0) {}
 
+        void add(int index, int delta)
+        {
+            for (++index; index < static_cast<int>(m_tree.size()); index += index & -index)
+            {
+                m_tree[index] += delta;
+            }
+        }
+
+        // sum of the counts at indices lower than 'index'
+        int prefix(int index) const
+        {
+            int sum = 0;
+            for (; index > 0; index -= index & -index)
+            {
+                sum += m_tree[index];
+            }
+            return sum;
+        }
+
+    private:
+        std::vector<int> m_tree;
+    };
+
+    // Returns flags of elements which belong to the longest (strictly) increasing subsequence, O(n log n).
+    static std::vector<bool> longestIncreasingSubsequence(std::vector<int> const& values)
+    {
+        std::vector<int> tails; // tails[k] is the index of the smallest tail value of an increasing subsequence of length k+1
+        std::vector<int> predecessors(values.size(), -1);
+        for (int i = 0; i < static_cast<int>(values.size()); i++)
+        {
+            auto it = std::lower_bound(tails.begin(), tails.end(), values[i], [&values](int idx, int value) { return values[idx] < value; });
+            if (it != tails.begin())
+            {
+                predecessors[i] = *(it - 1);
+            }
+            if (it == tails.end())
+            {
+                tails.push_back(i);
+            }
+            else
+            {
+                *it = i;
+            }
+        }
+
+        std::vector<bool> result(values.size(), false);
+        for (int i = tails.empty() ? -1 : tails.back(); i >= 0; i = predecessors[i])
+        {
+            result[i] = true;
+        }
+        return result;
     }
 };
 
@@ -70,6 +70,7 @@ void OptionSelectorFilter::reset()
         state->remove(m_filter->id());
         qDebug() << "Removing filter state for filter" << QString::fromStdString(m_filter->id());
         m_options->update(m_filter->active_options(*state), true);
+        refreshActiveFiltersCount();
         Q_EMIT filterStateChanged();
     }
 }
@@ -89,12 +90,14 @@ void OptionSelectorFilter::onOptionChecked(const QString& id, bool checked)
                 // However, we pass allow_defaults = false, so that user is able to unselect all options and they are
                 // not forcefully reset to defaults if this happens.
                 m_options->update(m_filter->active_options(*state), false);
+                refreshActiveFiltersCount();
                 Q_EMIT filterStateChanged();
                 return;
             }
         }
         qDebug() << "Removing filter state for filter" << QString::fromStdString(m_filter->id());
         state->remove(m_filter->id());
+        refreshActiveFiltersCount();
     }
 }
 
@@ -107,6 +110,7 @@ void OptionSelectorFilter::update(unity::scopes::FilterState::SPtr const& filter
 {
     m_filterState = filterState;
     m_options->update(m_filter->active_options(*filterState), true);
+    refreshActiveFiltersCount();
 }
 
 void OptionSelectorFilter::update(unity::scopes::FilterBase::SCPtr const& filter)
@@ -141,6 +145,7 @@ void OptionSelectorFilter::update(unity::scopes::FilterBase::SCPtr const& filter
     if (auto state = m_filterState.lock()) {
         m_options->update(m_filter->active_options(*state), false);
     }
+    refreshActiveFiltersCount();
 }
 
 int OptionSelectorFilter::activeFiltersCount() const
@@ -151,6 +156,11 @@ int OptionSelectorFilter::activeFiltersCount() const
     return 0;
 }
 
+void OptionSelectorFilter::emitActiveFiltersCountChanged(int delta)
+{
+    Q_EMIT activeFiltersCountChanged(delta);
+}
+
 QString OptionSelectorFilter::filterTag() const
 {
     if (m_multiSelect) {
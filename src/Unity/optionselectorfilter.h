@@ -50,6 +50,10 @@ public:
 
 Q_SIGNALS:
     void filterStateChanged();
+    void activeFiltersCountChanged(int delta);
+
+protected:
+    void emitActiveFiltersCountChanged(int delta) override;
 
 protected Q_SLOTS:
     void onOptionChecked(const QString& id, bool checked);
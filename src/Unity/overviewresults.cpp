@@ -27,6 +27,8 @@
 #include <unity/scopes/Result.h>
 #include <unity/scopes/Scope.h>
 #include <QSet>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 
 namespace scopes_ng {
 
@@ -63,13 +65,33 @@ private:
     }
 };
 
+namespace
+{
+
+struct ChildScopesReply
+{
+    bool ok = false;
+    QStringList ids;
+};
+
+} // namespace
+
 OverviewResultsModel::OverviewResultsModel(QObject* parent)
  : unity::shell::scopes::ResultsModelInterface(parent)
+ , m_childScopesRequest(0)
 {
 }
 
 void OverviewResultsModel::setResults(const QList<unity::scopes::ScopeMetadata::SPtr>& results, const QMap<QString, QString>& scopeIdToName)
 {
+    // scopes were installed or removed, so aggregators may have different child scopes now;
+    // changed metadata of an aggregator is detected per scope in updateChildScopes()
+    if (m_scopeIdToName.keys() != scopeIdToName.keys()) {
+        m_childScopeCache.clear();
+        m_pendingChildScopes.clear();
+    }
+    m_scopeIdToName = scopeIdToName;
+
     if (m_results.empty()) {
         beginResetModel();
         m_results = results;
@@ -175,38 +197,116 @@ bool OverviewResultsModel::updateChildScopes(const unity::scopes::ScopeMetadata:
         return false;
     }
 
-    unity::scopes::ChildScopeList children;
-    try
+    const QString scopeId(QString::fromStdString(scopeMetadata->scope_id()));
+    auto cached = m_childScopeCache.constFind(scopeId);
+    if (cached != m_childScopeCache.constEnd() && cached->metadata == scopeMetadata)
     {
-        children = scopeMetadata->proxy()->child_scopes();
+        return setChildScopeNames(scopeId, cached->ids);
     }
-    catch (std::exception const& e)
+
+    // child_scopes() is a blocking call into the aggregator, don't make the dash wait for it
+    fetchChildScopes(scopeMetadata);
+    return false;
+}
+
+void OverviewResultsModel::fetchChildScopes(const unity::scopes::ScopeMetadata::SPtr& scopeMetadata)
+{
+    const QString scopeId(QString::fromStdString(scopeMetadata->scope_id()));
+    auto pending = m_pendingChildScopes.constFind(scopeId);
+    if (pending != m_pendingChildScopes.constEnd() && pending->metadata == scopeMetadata)
     {
-        qWarning("OverviewResultsModel::updateChildScopes: Exception caught from proxy()->child_scopes(): %s", e.what());
-        return false;
+        return;
     }
 
-    if (children.size())
+    ChildScopes request;
+    request.metadata = scopeMetadata;
+    request.request = ++m_childScopesRequest;
+    m_pendingChildScopes[scopeId] = request;
+
+    auto watcher = new QFutureWatcher<ChildScopesReply>(this);
+    const int requestId = request.request;
+    QObject::connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, scopeId, requestId]() {
+        const ChildScopesReply reply = watcher->result();
+        watcher->deleteLater();
+        childScopesFetched(scopeId, requestId, reply.ok, reply.ids);
+    });
+    watcher->setFuture(QtConcurrent::run([scopeMetadata]() {
+        ChildScopesReply reply;
+        try
+        {
+            for (auto const& child : scopeMetadata->proxy()->child_scopes())
+            {
+                reply.ids << QString::fromStdString(child.id);
+            }
+            reply.ok = true;
+        }
+        catch (std::exception const& e)
+        {
+            qWarning("OverviewResultsModel::fetchChildScopes: Exception caught from proxy()->child_scopes(): %s", e.what());
+        }
+        return reply;
+    }));
+}
+
+void OverviewResultsModel::childScopesFetched(const QString& scopeId, int request, bool ok, const QStringList& childIds)
+{
+    auto pending = m_pendingChildScopes.find(scopeId);
+    if (pending == m_pendingChildScopes.end() || pending->request != request)
+    {
+        // superseded by a newer request, or the cache was invalidated in the meantime
+        return;
+    }
+    ChildScopes entry = pending.value();
+    m_pendingChildScopes.erase(pending);
+
+    if (!ok)
+    {
+        return;
+    }
+
+    entry.ids = childIds;
+    m_childScopeCache[scopeId] = entry;
+
+    const int row = scopeIndex(scopeId);
+    if (setChildScopeNames(scopeId, childIds) && row >= 0)
+    {
+        // update aggregator subtitle now that its child scopes are known
+        Q_EMIT dataChanged(index(row), index(row), {RoleSubtitle});
+    }
+}
+
+bool OverviewResultsModel::setChildScopeNames(const QString& scopeId, const QStringList& childIds)
+{
+    QString subtitle;
+    if (childIds.size())
     {
         // iterate over child scope ids, join their display names and insert into m_childScopes for current scope
         QStringList childNames;
-        for (auto const& child : children)
+        for (auto const& id : childIds)
         {
-            auto it = scopeIdToName.find(QString::fromStdString(child.id));
-            if (it != scopeIdToName.end())
+            auto it = m_scopeIdToName.find(id);
+            if (it != m_scopeIdToName.end())
             {
                 childNames << *it;
             }
         }
-        if (!childNames.empty())
+        if (childNames.empty())
         {
-            m_childScopes[QString::fromStdString(scopeMetadata->scope_id())] = childNames.join(QStringLiteral(", "));
+            return false;
         }
+        subtitle = childNames.join(QStringLiteral(", "));
     }
     else
     {
-        m_childScopes[QString::fromStdString(scopeMetadata->scope_id())] = QLatin1String("");
+        subtitle = QLatin1String("");
+    }
+
+    auto it = m_childScopes.find(scopeId);
+    if (it != m_childScopes.end() && *it == subtitle)
+    {
+        return false;
     }
+    m_childScopes[scopeId] = subtitle;
     return true;
 }
 
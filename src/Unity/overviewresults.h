@@ -26,6 +26,7 @@
 
 #include <QHash>
 #include <QMap>
+#include <QStringList>
 
 namespace scopes_ng {
 
@@ -55,9 +56,25 @@ public:
     Q_INVOKABLE int scopeIndex(const QString& scopeId) const;
 
 private:
+    struct ChildScopes
+    {
+        unity::scopes::ScopeMetadata::SPtr metadata; // metadata of the aggregator the child scopes were queried for
+        QStringList ids;
+        int request = 0;
+    };
+
     bool updateChildScopes(const unity::scopes::ScopeMetadata::SPtr& scopeMetadata, const QMap<QString, QString>& scopeIdToName);
+    void fetchChildScopes(const unity::scopes::ScopeMetadata::SPtr& scopeMetadata);
+    void childScopesFetched(const QString& scopeId, int request, bool ok, const QStringList& childIds);
+    bool setChildScopeNames(const QString& scopeId, const QStringList& childIds);
+
     QList<unity::scopes::ScopeMetadata::SPtr> m_results;
     QMap<QString, QString> m_childScopes;
+    QMap<QString, QString> m_scopeIdToName;
+    // child scopes of aggregators, enumerated in the background
+    QHash<QString, ChildScopes> m_childScopeCache;
+    QHash<QString, ChildScopes> m_pendingChildScopes;
+    int m_childScopesRequest;
 };
 
 } // namespace scopes_ng
@@ -32,6 +32,7 @@
 #include "previewmodel.h"
 #include "previewwidgetmodel.h"
 #include "settingsmodel.h"
+#include "lazyvariant.h"
 #include <unity/shell/scopes/FiltersInterface.h>
 #include <unity/shell/scopes/OptionSelectorFilterInterface.h>
 #include <unity/shell/scopes/OptionSelectorOptionsInterface.h>
@@ -55,6 +56,7 @@ void UnityPlugin::registerTypes(const char *uri)
     qmlRegisterUncreatableType<scopes_ng::ResultsModel>(uri, 0, 2, "ResultsModel", QStringLiteral("Can't create new ResultsModel in QML. Get them from Categories instance."));
     qmlRegisterUncreatableType<unity::shell::scopes::PreviewModelInterface>(uri, 0, 2, "PreviewModel", QStringLiteral("Can't create new PreviewModel in QML. Get them from Scope instance."));
     qmlRegisterUncreatableType<scopes_ng::PreviewWidgetModel>(uri, 0, 2, "PreviewWidgetModel", QStringLiteral("Can't create new PreviewWidgetModel in QML. Get them from PreviewModel instance."));
+    qmlRegisterUncreatableType<scopes_ng::LazyVariant>(uri, 0, 2, "LazyVariant", QStringLiteral("Can't create new LazyVariant in QML. Get them from ResultsModel or PreviewModel instance."));
     qmlRegisterUncreatableType<unity::shell::scopes::FiltersInterface>(uri, 0, 2, "Filters", "Can't create Filters object in QML. Get them from Scope instance.");
     qmlRegisterUncreatableType<unity::shell::scopes::FilterBaseInterface>(uri, 0, 2, "Filter", "Can't create Filter object in QML. Get them from Scope instance.");
     qmlRegisterUncreatableType<unity::shell::scopes::OptionSelectorOptionsInterface>(uri, 0, 2, "OptionSelectorOptions", "Can't create Filters object in QML. Get them from OptionSelector instance.");
@@ -27,12 +27,14 @@
 #include "previewwidgetmodel.h"
 #include "resultsmodel.h"
 #include "utils.h"
+#include "lazyvariant.h"
 #include "logintoaccount.h"
 
 // Qt
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
+#include <QQmlEngine>
 
 #include <unity/scopes/Scope.h>
 #include <unity/scopes/ActionMetadata.h>
@@ -46,7 +48,8 @@ PreviewModel::PreviewModel(QObject* parent) :
     unity::shell::scopes::PreviewModelInterface (parent),
     m_loaded(false),
     m_processingAction(false),
-    m_widgetColumnCount(1)
+    m_widgetColumnCount(1),
+    m_lazyVariants(LazyVariant::enabled())
 {
     connect(this, &PreviewModel::triggered, this, &PreviewModel::widgetTriggered);
 
@@ -64,6 +67,8 @@ PreviewModel::~PreviewModel()
     if (m_lastActivation) {
         m_lastActivation->invalidate();
     }
+
+    qDeleteAll(m_lazyValues);
 }
 
 void PreviewModel::setResult(std::shared_ptr<scopes::Result> const& result)
@@ -302,9 +307,7 @@ void PreviewModel::processWidgetDefinitions(unity::scopes::PreviewWidgetList con
         processComponents(components, attributes);
 
         // collect all attributes and their values
-        for (auto const& attr_pair : widget.attribute_values()) {
-            attributes[QString::fromStdString(attr_pair.first)] = scopeVariantToQVariant(attr_pair.second);
-        }
+        processAttributeValues(widget, attributes);
 
         if (!widget_type.isEmpty()) {
             QList<QSharedPointer<PreviewWidgetData>> collapsedWidgets; // only used if type == 'expandable'
@@ -321,9 +324,7 @@ void PreviewModel::processWidgetDefinitions(unity::scopes::PreviewWidgetList con
                     processComponents(components2, attributes2);
 
                     // collect all attributes and their values
-                    for (auto const& attr_pair : w.attribute_values()) {
-                        attributes2[QString::fromStdString(attr_pair.first)] = scopeVariantToQVariant(attr_pair.second);
-                    }
+                    processAttributeValues(w, attributes2);
 
                     auto subWidgetData = QSharedPointer<PreviewWidgetData>(new PreviewWidgetData(QString::fromStdString(w.id()), QString::fromStdString(w.widget_type()),
                                 components2, attributes2));
@@ -366,7 +367,12 @@ void PreviewModel::processComponents(QHash<QString, QString> const& components,
         if (m_allData.contains(field_name)) {
             out_attributes[component_name] = m_allData.value(field_name);
         } else if (m_previewedResult && m_previewedResult->contains(field_name.toStdString())) {
-            out_attributes[component_name] = scopeVariantToQVariant(m_previewedResult->value(field_name.toStdString()));
+            scopes::Variant const& value = m_previewedResult->value(field_name.toStdString());
+            if (m_lazyVariants) {
+                out_attributes[component_name] = lazyValue(qMakePair(QString(), field_name), std::shared_ptr<const scopes::Variant>(m_previewedResult, &value));
+            } else {
+                out_attributes[component_name] = scopeVariantToQVariant(value);
+            }
         } else {
             // FIXME: should we do this?
             out_attributes[component_name] = QVariant();
@@ -374,6 +380,47 @@ void PreviewModel::processComponents(QHash<QString, QString> const& components,
     }
 }
 
+void PreviewModel::processAttributeValues(scopes::PreviewWidget const& widget, QVariantMap& out_attributes)
+{
+    if (!m_lazyVariants) {
+        for (auto const& attr_pair : widget.attribute_values()) {
+            out_attributes[QString::fromStdString(attr_pair.first)] = scopeVariantToQVariant(attr_pair.second);
+        }
+        return;
+    }
+
+    // the wrappers share the attribute values instead of converting them up front
+    const QString widgetId(QString::fromStdString(widget.id()));
+    auto const values = std::make_shared<const scopes::VariantMap>(widget.attribute_values());
+    for (auto const& attr_pair : *values) {
+        const QString name(QString::fromStdString(attr_pair.first));
+        out_attributes[name] = lazyValue(qMakePair(widgetId, name), std::shared_ptr<const scopes::Variant>(values, &attr_pair.second));
+    }
+}
+
+QVariant PreviewModel::lazyValue(QPair<QString, QString> const& key, std::shared_ptr<const scopes::Variant> const& value)
+{
+    if (value->which() != scopes::Variant::Type::Dict && value->which() != scopes::Variant::Type::Array) {
+        return scopeVariantToQVariant(*value);
+    }
+
+    // QVariants compare wrappers by pointer, so hand out the same wrapper while the value doesn't change;
+    // otherwise every preview update would report all widgets as changed
+    auto it = m_lazyValues.find(key);
+    if (it != m_lazyValues.end()) {
+        if (&it.value()->scopeVariant() == value.get() || it.value()->scopeVariant() == *value) {
+            return QVariant::fromValue(it.value());
+        }
+        it.value()->deleteLater();
+        m_lazyValues.erase(it);
+    }
+
+    LazyVariant* wrapper = new LazyVariant(value);
+    QQmlEngine::setObjectOwnership(wrapper, QQmlEngine::CppOwnership);
+    m_lazyValues.insert(key, wrapper);
+    return QVariant::fromValue(wrapper);
+}
+
 QPair<int, int> PreviewModel::determinePositionFromLayout(QString const& widgetId) const
 {
     //
@@ -638,7 +685,7 @@ void PreviewModel::widgetTriggered(QString const& widgetId, QString const& actio
 
         if (m_associatedScope && widgetData->data.contains(QStringLiteral("online_account_details")))
         {
-            QVariantMap details = widgetData->data.value(QStringLiteral("online_account_details")).toMap();
+            QVariantMap details = LazyVariant::toQVariant(widgetData->data.value(QStringLiteral("online_account_details"))).toMap();
             if (details.contains(QStringLiteral("service_name")) &&
                 details.contains(QStringLiteral("service_type")) &&
                 details.contains(QStringLiteral("provider_name")) &&
@@ -663,6 +710,7 @@ void PreviewModel::widgetTriggered(QString const& widgetId, QString const& actio
                             case scopes::OnlineAccountClient::DoNothing:
                                 return;
                             case scopes::OnlineAccountClient::InvalidateResults:
+                                m_associatedScope->invalidateSearchCache();
                                 m_associatedScope->invalidateResults();
                                 return;
                             default:
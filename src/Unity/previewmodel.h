@@ -41,6 +41,8 @@
 namespace scopes_ng
 {
 
+class LazyVariant;
+
 struct PreviewWidgetData
 {
     QString id;
@@ -126,11 +128,14 @@ private:
     QPair<int, int> determinePositionFromLayout(QString const&) const;
     void addWidgetToColumnModel(QSharedPointer<PreviewWidgetData> const&);
     void processComponents(QHash<QString, QString> const& components, QVariantMap& out_attributes);
+    void processAttributeValues(unity::scopes::PreviewWidget const& widget, QVariantMap& out_attributes);
+    QVariant lazyValue(QPair<QString, QString> const& key, std::shared_ptr<const unity::scopes::Variant> const& value);
     void dispatchPreview(unity::scopes::Variant const& extra_data = unity::scopes::Variant());
 
     bool m_loaded;
     bool m_processingAction;
     int m_widgetColumnCount;
+    bool m_lazyVariants;
     QMap<QString, QVariant> m_allData; // attribute values (field name -> value)
     QHash<int, QList<QStringList>> m_columnLayouts; // number of columns -> list of lists of widget ids
 
@@ -138,6 +143,7 @@ private:
     QMap<QString, QSharedPointer<PreviewWidgetData>> m_previewWidgets; // all widgets, regardless of their columns
     QList<QSharedPointer<PreviewWidgetData>> m_previewWidgetsOrdered; // all widgets, in the order they were received
     QMultiMap<QString, PreviewWidgetData*> m_dataToWidgetMap;
+    QHash<QPair<QString, QString>, LazyVariant*> m_lazyValues; // (widget id, attribute) or (empty, result field) -> wrapper
 
     unity::scopes::QueryCtrlProxy m_lastPreviewQuery;
     QPointer<scopes_ng::Scope> m_associatedScope;
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "queryscheduler.h"
+#include "scope.h"
+
+#include <QDebug>
+
+#include <algorithm>
+
+namespace scopes_ng
+{
+
+const int REFRESH_SLOT = 5000; // granularity of TTL refreshes in ms
+
+QueryScheduler::QueryScheduler(int maxConcurrentQueries, QObject* parent)
+    : QObject(parent)
+    , m_maxConcurrentQueries(std::max(1, maxConcurrentQueries))
+    , m_dispatchPending(false)
+{
+    m_clock.start();
+}
+
+int QueryScheduler::maxConcurrentQueries() const
+{
+    return m_maxConcurrentQueries;
+}
+
+int QueryScheduler::runningCount() const
+{
+    return m_running.size();
+}
+
+int QueryScheduler::queuedCount() const
+{
+    return m_queue.size();
+}
+
+int QueryScheduler::findQueued(QObject* owner) const
+{
+    for (int i = 0; i < m_queue.size(); i++) {
+        if (m_queue[i].owner == owner) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void QueryScheduler::enqueue(Job const& job)
+{
+    const int pos = findQueued(job.owner.data());
+    if (pos >= 0) {
+        Job& queued = m_queue[pos];
+        if (job.priority <= queued.priority) {
+            queued.priority = job.priority;
+            queued.dispatch = job.dispatch;
+            queued.cancel = job.cancel;
+        }
+    } else {
+        m_queue.append(job);
+    }
+    scheduleDispatch();
+}
+
+void QueryScheduler::schedule(Scope* scope, Priority priority, std::function<void()> const& dispatch)
+{
+    Job job;
+    job.owner = scope;
+    job.scope = scope;
+    job.priority = priority;
+    job.dispatch = [scope, dispatch]() {
+        dispatch();
+        // not running if answered from cache, or failed to start
+        return scope->searchRunning();
+    };
+    job.cancel = [scope]() { scope->cancelSearch(); };
+    enqueue(job);
+}
+
+void QueryScheduler::scheduleQuery(QObject* query, Scope* scope, Priority priority, std::function<bool()> const& dispatch,
+        std::function<void()> const& cancel)
+{
+    Job job;
+    job.owner = query;
+    job.scope = scope;
+    job.priority = priority;
+    job.dispatch = dispatch;
+    job.cancel = cancel;
+    enqueue(job);
+}
+
+void QueryScheduler::promote(Scope* scope)
+{
+    const int pos = findQueued(scope);
+    if (pos >= 0) {
+        Job job = m_queue.takeAt(pos);
+        job.priority = Priority::ActiveInteractive;
+        start(job);
+    }
+}
+
+void QueryScheduler::unschedule(Scope* scope)
+{
+    const int pos = findQueued(scope);
+    if (pos >= 0) {
+        m_queue.removeAt(pos);
+    }
+}
+
+void QueryScheduler::unscheduleQuery(QObject* query)
+{
+    const int pos = findQueued(query);
+    if (pos >= 0) {
+        m_queue.removeAt(pos);
+    }
+    finished(query);
+}
+
+void QueryScheduler::beginInteractive(Scope* scope)
+{
+    m_interactiveScope = scope;
+
+    // preempt scheduled searches of other scopes; they are restarted once the user is done
+    for (auto it = m_running.begin(); it != m_running.end(); ) {
+        if (it->owner && it->owner != scope && it->priority != Priority::ActiveInteractive) {
+            Job job = *it;
+            it = m_running.erase(it);
+            QObject::disconnect(job.connection);
+            if (job.scope) {
+                qDebug() << "Preempting search of" << job.scope->id();
+            }
+            job.cancel();
+            m_queue.prepend(job);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void QueryScheduler::endInteractive(Scope* scope)
+{
+    if (m_interactiveScope == scope) {
+        m_interactiveScope.clear();
+        scheduleDispatch();
+    }
+}
+
+int QueryScheduler::alignRefreshDelay(int delay) const
+{
+    if (delay <= 0) {
+        return delay;
+    }
+
+    const qint64 due = m_clock.elapsed() + delay;
+    const qint64 extra = (REFRESH_SLOT - due % REFRESH_SLOT) % REFRESH_SLOT;
+    // don't postpone short TTLs by more than a fifth
+    if (extra > delay / 5) {
+        return delay;
+    }
+    return delay + static_cast<int>(extra);
+}
+
+void QueryScheduler::scheduleDispatch()
+{
+    if (!m_dispatchPending) {
+        m_dispatchPending = true;
+        QMetaObject::invokeMethod(this, "dispatchNext", Qt::QueuedConnection);
+    }
+}
+
+void QueryScheduler::dispatchNext()
+{
+    m_dispatchPending = false;
+
+    // forget about destroyed scopes and queries
+    auto isGone = [](Job const& job) { return job.owner.isNull() || job.scope.isNull(); };
+    m_running.erase(std::remove_if(m_running.begin(), m_running.end(), isGone), m_running.end());
+    m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(), isGone), m_queue.end());
+
+    while (!m_queue.isEmpty() && m_running.size() < m_maxConcurrentQueries && !m_interactiveScope) {
+        // highest priority first; within the same priority prefer scopes which answered quickly so far
+        auto next = std::min_element(m_queue.begin(), m_queue.end(), [](Job const& a, Job const& b) {
+            if (a.priority != b.priority) {
+                return a.priority < b.priority;
+            }
+            return std::max<qint64>(0, a.scope->averageSearchLatency()) < std::max<qint64>(0, b.scope->averageSearchLatency());
+        });
+        Job job = *next;
+        m_queue.erase(next);
+        start(job);
+    }
+}
+
+void QueryScheduler::start(Job job)
+{
+    Scope* scope = job.scope.data();
+    if (scope == nullptr || job.owner.isNull()) {
+        return;
+    }
+
+    if (!job.dispatch()) {
+        scheduleDispatch();
+        return;
+    }
+
+    // other queries report their end via unscheduleQuery()
+    if (job.owner == scope) {
+        job.connection = QObject::connect(scope, &Scope::searchRunningChanged, this, [this, scope]() {
+            if (!scope->searchRunning()) {
+                finished(scope);
+            }
+        });
+    }
+    m_running.append(job);
+}
+
+void QueryScheduler::finished(QObject* owner)
+{
+    for (auto it = m_running.begin(); it != m_running.end(); ++it) {
+        if (it->owner == owner) {
+            QObject::disconnect(it->connection);
+            m_running.erase(it);
+            break;
+        }
+    }
+    scheduleDispatch();
+}
+
+} // namespace scopes_ng
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NG_QUERY_SCHEDULER_H
+#define NG_QUERY_SCHEDULER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QPointer>
+
+#include <functional>
+
+namespace scopes_ng
+{
+
+class Scope;
+
+/**
+  Schedules searches that are not directly requested by the user (prepopulation of scopes,
+  TTL refreshes etc.), so that they don't compete with searches of the active scope.
+*/
+class Q_DECL_EXPORT QueryScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Priority
+    {
+        ActiveInteractive,
+        VisibleNeighbour,
+        ProgrammaticRefresh, // scope or registry changed, e.g. before the first location prompt
+        BackgroundPrefetch,
+        TtlRefresh
+    };
+
+    explicit QueryScheduler(int maxConcurrentQueries, QObject* parent = nullptr);
+
+    // Queues a search of the scope, started by calling dispatch once there's a free slot.
+    // A scope has at most one queued search; scheduling it again keeps the higher priority.
+    void schedule(Scope* scope, Priority priority, std::function<void()> const& dispatch);
+    // Starts the queued search of the scope right away, e.g. when the scope becomes active.
+    void promote(Scope* scope);
+    void unschedule(Scope* scope);
+
+    // Queues a search that doesn't update the results of the scope, e.g. a department prefetch.
+    // The query object identifies the search; dispatch returns false if no search was started,
+    // otherwise the end of the search is reported by calling unscheduleQuery(). cancel is called
+    // when the search gets preempted, it's dispatched again later.
+    void scheduleQuery(QObject* query, Scope* scope, Priority priority, std::function<bool()> const& dispatch,
+            std::function<void()> const& cancel);
+    void unscheduleQuery(QObject* query);
+
+    // The user interacts with the scope: running scheduled searches of other scopes are cancelled
+    // and queued again, and no scheduled search starts until endInteractive() is called.
+    void beginInteractive(Scope* scope);
+    void endInteractive(Scope* scope);
+
+    // Rounds the delay of a TTL refresh up to a shared slot boundary, so that refreshes of
+    // different scopes are batched instead of firing at arbitrary times.
+    int alignRefreshDelay(int delay) const;
+
+    int maxConcurrentQueries() const;
+    int runningCount() const;
+    int queuedCount() const;
+
+private Q_SLOTS:
+    void dispatchNext();
+
+private:
+    struct Job
+    {
+        QPointer<QObject> owner; // the scope itself for searches updating its results
+        QPointer<Scope> scope;
+        Priority priority;
+        std::function<bool()> dispatch;
+        std::function<void()> cancel;
+        QMetaObject::Connection connection;
+    };
+
+    void enqueue(Job const& job);
+    void start(Job job);
+    void finished(QObject* owner);
+    void scheduleDispatch();
+    int findQueued(QObject* owner) const;
+
+    int m_maxConcurrentQueries;
+    bool m_dispatchPending;
+    QList<Job> m_queue;
+    QList<Job> m_running;
+    QPointer<Scope> m_interactiveScope;
+    QElapsedTimer m_clock;
+};
+
+} // namespace scopes_ng
+
+#endif
@@ -129,6 +129,8 @@ void RangeInputFilter::update(unity::scopes::FilterState::SPtr const& filterStat
         }
         Q_EMIT endValueChanged();
     }
+
+    refreshActiveFiltersCount();
 }
 
 void RangeInputFilter::update(unity::scopes::FilterBase::SCPtr const& filter)
@@ -152,6 +154,9 @@ void RangeInputFilter::update(unity::scopes::FilterBase::SCPtr const& filter)
     labelChange(m_filter->central_label(), m_centralLabel, [this]() { Q_EMIT centralLabelChanged(); });
     labelChange(m_filter->end_prefix_label(), m_endPrefixLabel, [this]() { Q_EMIT endPrefixLabelChanged(); });
     labelChange(m_filter->end_postfix_label(), m_endPostfixLabel, [this]() { Q_EMIT endPostfixLabelChanged(); });
+
+    // default values may have changed
+    refreshActiveFiltersCount();
 }
 
 int RangeInputFilter::activeFiltersCount() const
@@ -168,6 +173,11 @@ int RangeInputFilter::activeFiltersCount() const
     return 0;
 }
 
+void RangeInputFilter::emitActiveFiltersCountChanged(int delta)
+{
+    Q_EMIT activeFiltersCountChanged(delta);
+}
+
 QString RangeInputFilter::filterTag() const
 {
     return ""; // range input filter can't be a primary navigation filter
@@ -232,6 +242,7 @@ void RangeInputFilter::setStartValue(Variant const& value)
                     Q_EMIT hasStartValueChanged();
                 }
                 Q_EMIT startValueChanged();
+                refreshActiveFiltersCount();
                 Q_EMIT filterStateChanged();
             }
         }
@@ -257,6 +268,7 @@ void RangeInputFilter::setEndValue(Variant const& value)
                     Q_EMIT hasEndValueChanged();
                 }
                 Q_EMIT endValueChanged();
+                refreshActiveFiltersCount();
                 Q_EMIT filterStateChanged();
             }
         }
@@ -64,6 +64,10 @@ public:
 
 Q_SIGNALS:
     void filterStateChanged();
+    void activeFiltersCountChanged(int delta);
+
+protected:
+    void emitActiveFiltersCountChanged(int delta) override;
 
 private:
     void setStartValue(unity::scopes::Variant const& value);
@@ -23,9 +23,11 @@
 // local
 #include "utils.h"
 #include "iconutils.h"
+#include "lazyvariant.h"
 
 #include <map>
 #include <QDebug>
+#include <QQmlEngine>
 
 namespace scopes_ng {
 
@@ -42,10 +44,17 @@ ResultsModel::ResultsModel(QObject* parent)
  : unity::shell::scopes::ResultsModelInterface(parent)
  , m_maxAttributes(2)
  , m_purge(true)
+ , m_memoryUsage(0)
+ , m_lazyVariants(LazyVariant::enabled())
 {
     m_componentMapping.resize(RoleSocialActions + 1);
 }
 
+ResultsModel::~ResultsModel()
+{
+    qDeleteAll(m_lazyValues);
+}
+
 QString ResultsModel::categoryId() const
 {
     return m_categoryId;
@@ -97,6 +106,7 @@ void ResultsModel::setComponentsMapping(QHash<QString, QString> const& mapping)
     if (rowCount() > 0) {
         beginResetModel();
         m_componentMapping = newMapping;
+        clearLazyValues();
         endResetModel();
     } else {
         m_componentMapping = newMapping;
@@ -142,6 +152,8 @@ void ResultsModel::addUpdateResults(QList<std::shared_ptr<unity::scopes::Categor
             if (!haveNow) {
                 // delete row
                 beginRemoveRows(QModelIndex(), row, row);
+                removeResultSize(it->get());
+                removeLazyValues(it->get());
                 it = m_results.erase(it);
                 endRemoveRows();
             } else {
@@ -176,6 +188,7 @@ void ResultsModel::addUpdateResults(QList<std::shared_ptr<unity::scopes::Categor
             // insert row
             beginInsertRows(QModelIndex(), row, row);
             m_results.insert(row, results[row]);
+            addResultSize(results[row].get());
             m_search_ctx.oldResultsMap.updateIndices(m_results, row + 1, m_results.size());
             endInsertRows();
         }
@@ -208,6 +221,7 @@ void ResultsModel::addResults(QList<std::shared_ptr<unity::scopes::CategorisedRe
     beginInsertRows(QModelIndex(), m_results.count(), m_results.count() + results.count() - 1);
     for (auto const& result: results) {
         m_results.append(result);
+        addResultSize(result.get());
     }
     endInsertRows();
 
@@ -227,6 +241,9 @@ void ResultsModel::clearResults()
 
     beginRemoveRows(QModelIndex(), 0, m_results.count() - 1);
     m_results.clear();
+    m_resultSizes.clear();
+    m_memoryUsage = 0;
+    clearLazyValues();
     endRemoveRows();
 
     m_search_ctx.reset();
@@ -246,6 +263,43 @@ int ResultsModel::count() const
     return m_results.count();
 }
 
+qint64 ResultsModel::memoryUsage() const
+{
+    return m_memoryUsage;
+}
+
+void ResultsModel::addResultSize(scopes::Result const* result)
+{
+    if (!m_resultSizes.contains(result)) {
+        const qint64 size = estimateResultSize(*result);
+        m_resultSizes.insert(result, size);
+        m_memoryUsage += size;
+    }
+}
+
+void ResultsModel::removeResultSize(scopes::Result const* result)
+{
+    m_memoryUsage -= m_resultSizes.take(result);
+}
+
+void ResultsModel::removeLazyValues(scopes::Result const* result)
+{
+    for (int role : {RoleQuickPreviewData, RoleSocialActions}) {
+        LazyVariant* wrapper = m_lazyValues.take(qMakePair(result, role));
+        if (wrapper) {
+            wrapper->deleteLater();
+        }
+    }
+}
+
+void ResultsModel::clearLazyValues()
+{
+    for (LazyVariant* wrapper : m_lazyValues) {
+        wrapper->deleteLater();
+    }
+    m_lazyValues.clear();
+}
+
 QVariant
 ResultsModel::componentValue(scopes::Result const* result, Roles field) const
 {
@@ -262,6 +316,29 @@ ResultsModel::componentValue(scopes::Result const* result, Roles field) const
     }
 }
 
+QVariant
+ResultsModel::lazyComponentValue(std::shared_ptr<scopes::Result> const& result, Roles field) const
+{
+    std::string const& realFieldName = m_componentMapping[field];
+    if (realFieldName.empty() || !result->contains(realFieldName))
+        return QVariant();
+    scopes::Variant const& value = result->value(realFieldName);
+    if (value.which() != scopes::Variant::Type::Dict && value.which() != scopes::Variant::Type::Array)
+        return scopeVariantToQVariant(value);
+
+    // results don't change once they're in the model (updates replace them), so hand out the same
+    // wrapper on every call; QML compares wrappers by pointer and bindings are evaluated often
+    const auto key = qMakePair(static_cast<scopes::Result const*>(result.get()), static_cast<int>(field));
+    LazyVariant* wrapper = m_lazyValues.value(key);
+    if (!wrapper) {
+        // share the value with the result instead of converting the whole tree up front
+        wrapper = new LazyVariant(std::shared_ptr<const scopes::Variant>(result, &value));
+        QQmlEngine::setObjectOwnership(wrapper, QQmlEngine::CppOwnership);
+        m_lazyValues.insert(key, wrapper);
+    }
+    return QVariant::fromValue(wrapper);
+}
+
 QVariant
 ResultsModel::attributesValue(scopes::Result const* result) const
 {
@@ -310,7 +387,10 @@ void ResultsModel::updateResult(scopes::Result const& result, scopes::Result con
         if (result.uri() == res->uri() && result.serialize() == res->serialize())
         {
             qDebug() << "Updated result with uri '" << QString::fromStdString(res->uri()) << "'";
+            removeResultSize(res.get());
+            removeLazyValues(res.get());
             m_results[i] = std::make_shared<scopes::Result>(updatedResult);
+            addResultSize(m_results[i].get());
             auto const idx = index(i, 0);
             Q_EMIT dataChanged(idx, idx);
             return;
@@ -366,8 +446,12 @@ ResultsModel::data(const QModelIndex& index, int role) const
         case RoleEmblem:
         case RoleSummary:
         case RoleOverlayColor:
+            return componentValue(result, Roles(role));
         case RoleQuickPreviewData:
         case RoleSocialActions:
+            if (m_lazyVariants) {
+                return lazyComponentValue(m_results.at(row), Roles(role));
+            }
             return componentValue(result, Roles(role));
         case RoleAttributes:
             return attributesValue(result);
@@ -31,6 +31,8 @@
 
 namespace scopes_ng {
 
+class LazyVariant;
+
 struct SearchContext
 {
     ResultsMap newResultsMap;
@@ -50,6 +52,7 @@ public:
     };
 
     explicit ResultsModel(QObject* parent = 0);
+    ~ResultsModel();
 
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
@@ -61,6 +64,7 @@ public:
     /* getters */
     QString categoryId() const override;
     int count() const override;
+    qint64 memoryUsage() const;
 
     /* setters */
     void setCategoryId(QString const& id) override;
@@ -74,13 +78,22 @@ public:
 
 private:
     QVariant componentValue(unity::scopes::Result const* result, Roles field) const;
+    QVariant lazyComponentValue(std::shared_ptr<unity::scopes::Result> const& result, Roles field) const;
     QVariant attributesValue(unity::scopes::Result const* result) const;
+    void addResultSize(unity::scopes::Result const* result);
+    void removeResultSize(unity::scopes::Result const* result);
+    void removeLazyValues(unity::scopes::Result const* result);
+    void clearLazyValues();
 
     QVector<std::string> m_componentMapping;
     QList<std::shared_ptr<unity::scopes::Result>> m_results;
+    QHash<unity::scopes::Result const*, qint64> m_resultSizes; // estimated once, when a result is added
     QString m_categoryId;
     int m_maxAttributes;
     bool m_purge;
+    qint64 m_memoryUsage;
+    bool m_lazyVariants;
+    mutable QHash<QPair<unity::scopes::Result const*, int>, LazyVariant*> m_lazyValues; // (result, role) -> wrapper
     SearchContext m_search_ctx;
 };
 
@@ -44,7 +44,10 @@
 #include <QScopedPointer>
 #include <QFileInfo>
 #include <QDir>
+#include <QDateTime>
 #include <QLocale>
+#include <QHash>
+#include <QSet>
 #include <QtConcurrent>
 
 #include <QQmlEngine>
@@ -74,6 +77,10 @@ const int RESULTS_TTL_SMALL = 30000; // 30 seconds
 const int RESULTS_TTL_MEDIUM = 300000; // 5 minutes
 const int RESULTS_TTL_LARGE = 3600000; // 1 hour
 const int SEARCH_CARDINALITY = 300; // maximum number of results accepted from a single scope
+const int SEARCH_CACHE_SIZE = 5; // number of finished searches remembered per scope
+const int NAVIGATION_CACHE_SIZE = 5; // number of recently used navigation models kept, older ones are deleted
+const int DEPARTMENT_PREFETCH_LIMIT = 4; // maximum number of subdepartments prefetched after a search
+const int HIBERNATION_TIMEOUT = 600000; // inactive scopes hibernate after 10 minutes
 
 Scope::Ptr Scope::newInstance(scopes_ng::Scopes* parent, bool favorite)
 {
@@ -87,6 +94,10 @@ Scope::Scope(scopes_ng::Scopes* parent, bool favorite) :
     , m_activeFiltersCount(0)
     , m_isActive(false)
     , m_searchInProgress(false)
+    , m_revalidating(false)
+    , m_revalidationRequested(false)
+    , m_searchAfterLocation(false)
+    , m_searchAfterLocationProgrammatic(false)
     , m_activationInProgress(false)
     , m_resultsDirty(false)
     , m_delayedSearchProcessing(false)
@@ -97,6 +108,12 @@ Scope::Scope(scopes_ng::Scopes* parent, bool favorite) :
     , m_searchController(new CollectionController)
     , m_activationController(new CollectionController)
     , m_status(Status::Okay)
+    , m_searchCache(qEnvironmentVariableIsSet("UNITY_SCOPES_SEARCH_CACHE_SIZE") ?
+            qgetenv("UNITY_SCOPES_SEARCH_CACHE_SIZE").toInt() : SEARCH_CACHE_SIZE)
+    , m_departmentPrefetchEnabled(false)
+    , m_hibernated(false)
+    , m_lastViewed(0)
+    , m_searchLatency(-1)
 {
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
     m_categories.reset(new Categories(this));
@@ -128,11 +145,39 @@ Scope::Scope(scopes_ng::Scopes* parent, bool favorite) :
     QObject::connect(&m_searchProcessingDelayTimer, SIGNAL(timeout()), this, SLOT(flushUpdates()));
     m_invalidateTimer.setSingleShot(true);
     m_invalidateTimer.setTimerType(Qt::CoarseTimer);
-    QObject::connect(&m_invalidateTimer, &QTimer::timeout, [this]() { invalidateResults(); });
+    QObject::connect(&m_invalidateTimer, &QTimer::timeout, [this]() {
+        // refresh of the active scope goes through the scheduler so that it doesn't compete with interactive
+        // searches; it runs in the background and keeps the current results visible until the new ones are in
+        QueryScheduler* scheduler = queryScheduler();
+        if (m_isActive && scheduler) {
+            scheduler->schedule(this, QueryScheduler::Priority::TtlRefresh, [this]() { revalidateResults(); });
+        } else {
+            invalidateResults();
+        }
+    });
+    m_hibernationTimer.setSingleShot(true);
+    m_hibernationTimer.setTimerType(Qt::VeryCoarseTimer);
+    if (qEnvironmentVariableIsSet("UNITY_SCOPES_HIBERNATION_TIMEOUT")) {
+        m_hibernationTimer.setInterval(QString::fromUtf8(qgetenv("UNITY_SCOPES_HIBERNATION_TIMEOUT")).toInt());
+    } else {
+        m_hibernationTimer.setInterval(HIBERNATION_TIMEOUT);
+    }
+    QObject::connect(&m_hibernationTimer, &QTimer::timeout, this, &Scope::hibernate);
+
+    m_departmentPrefetcher.reset(new DepartmentPrefetcher);
+    QObject::connect(m_departmentPrefetcher.data(), &DepartmentPrefetcher::departmentPrefetched, [this](QString const& cacheKey, CachedSearch const& search) {
+        m_searchCache.insert(cacheKey, search);
+        if (m_scopesInstance) {
+            m_scopesInstance->scheduleMemoryBudgetCheck();
+        }
+    });
 }
 
 Scope::~Scope()
 {
+    Q_FOREACH(Department* navModel, m_departmentModels) {
+        releaseNavigationModel(navModel);
+    }
 }
 
 void Scope::processSearchChunk(PushEvent* pushEvent)
@@ -150,6 +195,10 @@ void Scope::processSearchChunk(PushEvent* pushEvent)
     m_rootDepartment = rootDepartment;
     m_receivedFilters = filters;
 
+    if (!m_searchCacheKey.isEmpty()) {
+        m_searchResults.append(results);
+    }
+
     if (m_cachedResults.empty()) {
         m_cachedResults.swap(results);
     } else {
@@ -157,7 +206,8 @@ void Scope::processSearchChunk(PushEvent* pushEvent)
     }
 
     if (status == CollectorBase::Status::INCOMPLETE) {
-        if (!m_searchProcessingDelayTimer.isActive()) {
+        // revalidation results are only applied once complete
+        if (!m_revalidating && !m_searchProcessingDelayTimer.isActive()) {
             // the longer we've been waiting for the results, the shorter the timeout
             qint64 inProgressMs = pushEvent->msecsSinceStart();
             double mult = 1.0 / std::max(1, static_cast<int>((inProgressMs / 150) + 1));
@@ -166,6 +216,19 @@ void Scope::processSearchChunk(PushEvent* pushEvent)
     } else { // status in [FINISHED, ERROR]
         m_searchProcessingDelayTimer.stop();
 
+        const bool revalidation = m_revalidating;
+        setRevalidating(false);
+        if (revalidation && status != CollectorBase::Status::FINISHED) {
+            // keep the stale results rather than replacing them with a partial result set, try again later
+            qDebug() << id() << ": Revalidation did not finish, keeping current results";
+            m_cachedResults.clear();
+            m_searchResults.clear();
+            m_category_results.clear();
+            setSearchInProgress(false);
+            startTtlTimer();
+            return;
+        }
+
         flushUpdates(true);
 
         setSearchInProgress(false);
@@ -187,8 +250,27 @@ void Scope::processSearchChunk(PushEvent* pushEvent)
 
         // Don't schedule a refresh if the query suffered an error
         if (status == CollectorBase::Status::FINISHED) {
+            const qint64 latency = pushEvent->msecsSinceStart();
+            m_searchLatency = m_searchLatency < 0 ? latency : (3 * m_searchLatency + latency) / 4;
             startTtlTimer();
+
+            if (!m_searchCacheKey.isEmpty()) {
+                CachedSearch search;
+                search.results.swap(m_searchResults);
+                // the results were just rendered, so their size is known already
+                search.size = m_categories->memoryUsage();
+                search.rootDepartment = m_rootDepartment;
+                search.filters = m_receivedFilters;
+                search.timestamp.start();
+                m_searchCache.insert(m_searchCacheKey, search);
+                m_displayedSearchKey = m_searchCacheKey;
+            }
+            if (m_scopesInstance) {
+                m_scopesInstance->scheduleMemoryBudgetCheck();
+            }
+            prefetchSubdepartments();
         }
+        m_searchResults.clear();
     }
 }
 
@@ -400,20 +482,24 @@ void Scope::flushUpdates(bool finalize)
                     node = m_departmentTree->findNodeById(QString::fromStdString(updateNode->id()));
                 }
             }
+            QSet<QString> changedNodes;
             if (updateNode) {
-                node->initializeForDepartment(updateNode);
+                node->updateForDepartment(updateNode, changedNodes);
             }
             // as far as we know, this is the root, re-initializing might have unset the flag
             m_departmentTree->setIsRoot(true);
 
             // update corresponding models
-            updateNavigationModels(m_departmentTree.data(), m_departmentModels, m_currentNavigationId);
+            updateNavigationModels(m_departmentTree.data(), m_departmentModels, m_currentNavigationId, changedNodes);
         } else {
             m_departmentTree.reset(new DepartmentNode);
             m_departmentTree->initializeForDepartment(m_rootDepartment);
             // as far as we know, this is the root, changing our mind later
             // is better than pretending it isn't
             m_departmentTree->setIsRoot(true);
+
+            // shared models handed out for the previous tree must not keep showing its contents
+            reloadNavigationModels();
         }
     }
 
@@ -472,26 +558,59 @@ Scope::Ptr Scope::findTempScope(QString const& id) const
     return Scope::Ptr();
 }
 
-void Scope::updateNavigationModels(DepartmentNode* rootNode, QMultiMap<QString, Department*>& navigationModels, QString const& activeNavigation)
+void Scope::updateNavigationModels(DepartmentNode* rootNode, QHash<QString, Department*>& navigationModels, QString const& activeNavigation, QSet<QString> const& changedNodes)
 {
+    // only reload models of the nodes which changed
+    for (auto it = navigationModels.begin(); it != navigationModels.end(); ++it) {
+        if (changedNodes.contains(it.key())) {
+            DepartmentNode* changedNode = rootNode->findNodeById(it.key());
+            if (changedNode != nullptr) {
+                it.value()->loadFromDepartmentNode(changedNode);
+            }
+        }
+    }
+
     DepartmentNode* parentNode = nullptr;
     DepartmentNode* node = rootNode->findNodeById(activeNavigation);
     if (node != nullptr) {
-        auto it = navigationModels.find(activeNavigation);
-        while (it != navigationModels.end() && it.key() == activeNavigation) {
-            it.value()->loadFromDepartmentNode(node);
-            ++it;
-        }
         // if this node is a leaf, we need to update models for the parent
         parentNode = node->isLeaf() ? node->parent() : nullptr;
     }
     if (parentNode != nullptr) {
         auto it = navigationModels.find(parentNode->id());
-        while (it != navigationModels.end() && it.key() == parentNode->id()) {
+        if (it != navigationModels.end()) {
             it.value()->markSubdepartmentActive(activeNavigation);
+        }
+    }
+}
+
+void Scope::reloadNavigationModels()
+{
+    for (auto it = m_departmentModels.begin(); it != m_departmentModels.end(); ) {
+        DepartmentNode* node = m_departmentTree ? m_departmentTree->findNodeById(it.key()) : nullptr;
+        if (node != nullptr) {
+            it.value()->loadFromDepartmentNode(node);
             ++it;
+        } else {
+            // the department is gone
+            Department* navModel = it.value();
+            releaseNavigationModel(navModel);
+            m_inverseDepartments.remove(navModel);
+            m_warmDepartmentModels.removeOne(navModel);
+            it = m_departmentModels.erase(it);
         }
     }
+
+    if (m_departmentTree) {
+        updateNavigationModels(m_departmentTree.data(), m_departmentModels, m_currentNavigationId, QSet<QString>());
+    }
+}
+
+void Scope::releaseNavigationModel(Department* navModel)
+{
+    // navigation models are owned by the scope; QML sees them as destroyed if it still references one
+    QObject::disconnect(navModel, nullptr, this, nullptr);
+    navModel->deleteLater();
 }
 
 scopes::Department::SCPtr Scope::findUpdateNode(DepartmentNode* node, scopes::Department::SCPtr const& scopeNode)
@@ -499,15 +618,16 @@ scopes::Department::SCPtr Scope::findUpdateNode(DepartmentNode* node, scopes::De
     if (node == nullptr || node->id() != QString::fromStdString(scopeNode->id())) return scopeNode;
 
     // are all the children in our cache?
-    QStringList cachedChildrenIds;
+    QSet<QString> cachedChildrenIds;
     const auto childNodes = node->childNodes();
     cachedChildrenIds.reserve(childNodes.count());
     Q_FOREACH(DepartmentNode* child, childNodes) {
-        cachedChildrenIds << child->id();
+        cachedChildrenIds.insert(child->id());
     }
 
     auto subdeps = scopeNode->subdepartments();
-    QMap<QString, scopes::Department::SCPtr> childIdMap;
+    QHash<QString, scopes::Department::SCPtr> childIdMap;
+    childIdMap.reserve(static_cast<int>(subdeps.size()));
     for (auto it = subdeps.begin(); it != subdeps.end(); ++it) {
         QString childId = QString::fromStdString((*it)->id());
         childIdMap.insert(childId, *it);
@@ -518,8 +638,8 @@ scopes::Department::SCPtr Scope::findUpdateNode(DepartmentNode* node, scopes::De
 
     scopes::Department::SCPtr firstMismatchingChild;
 
-    Q_FOREACH(DepartmentNode* child, node->childNodes()) {
-        scopes::Department::SCPtr scopeChildNode(childIdMap[child->id()]);
+    Q_FOREACH(DepartmentNode* child, childNodes) {
+        scopes::Department::SCPtr scopeChildNode(childIdMap.value(child->id()));
         // the cache might have more data than the node, should we consider that bad?
         if (!scopeChildNode) {
             continue;
@@ -612,13 +732,15 @@ void Scope::invalidateLastSearch()
         m_searchProcessingDelayTimer.stop();
     }
     m_cachedResults.clear();
+    m_searchResults.clear();
     m_category_results.clear();
+    setRevalidating(false);
 }
 
-void Scope::startTtlTimer()
+int Scope::resultsTtl() const
 {
+    int ttl = 0;
     if (m_scopeMetadata) {
-        int ttl = 0;
         switch (m_scopeMetadata->results_ttl_type()) {
         case (scopes::ScopeMetadata::ResultsTtlType::None):
             break;
@@ -637,9 +759,199 @@ void Scope::startTtlTimer()
                 ttl = QString::fromUtf8(
                         qgetenv("UNITY_SCOPES_RESULTS_TTL_OVERRIDE")).toInt();
             }
-            m_invalidateTimer.start(ttl);
         }
     }
+    return ttl;
+}
+
+void Scope::startTtlTimer()
+{
+    const int ttl = resultsTtl();
+    if (ttl > 0) {
+        QueryScheduler* scheduler = queryScheduler();
+        m_invalidateTimer.start(scheduler ? scheduler->alignRefreshDelay(ttl) : ttl);
+    }
+}
+
+bool Scope::processCachedSearch()
+{
+    CachedSearch search;
+    if (m_searchCacheKey.isEmpty() || !m_searchCache.lookup(m_searchCacheKey, search)) {
+        return false;
+    }
+
+    // render cached results right away, unless they are already displayed
+    if (m_searchCacheKey != m_displayedSearchKey) {
+        qDebug() << id() << ": Rendering" << search.results.count() << "cached results";
+        m_cachedResults = search.results;
+        m_rootDepartment = search.rootDepartment;
+        m_receivedFilters = search.filters;
+        m_searchProcessingDelayTimer.stop();
+        flushUpdates(true);
+        m_displayedSearchKey = m_searchCacheKey;
+    }
+
+    const int ttl = resultsTtl();
+    const qint64 age = search.timestamp.elapsed();
+    if (ttl > 0 && age < ttl) {
+        qDebug() << id() << ": Cached results are still valid, skipping search";
+        m_searchProcessingDelayTimer.stop();
+        m_delayedSearchProcessing = false;
+        QueryScheduler* scheduler = queryScheduler();
+        m_invalidateTimer.start(scheduler ? scheduler->alignRefreshDelay(ttl - age) : ttl - age);
+        prefetchSubdepartments();
+        return true;
+    }
+
+    // revalidate; results of the new search get diffed against the cached ones
+    m_category_results.clear();
+    m_categories->markNewSearch();
+    m_delayedSearchProcessing = true;
+    if (!m_revalidating) {
+        m_searchProcessingDelayTimer.start(SEARCH_PROCESSING_DELAY);
+    }
+    return false;
+}
+
+QString Scope::searchCacheKey(QString const& navigationId) const
+{
+    const QString key = buildQuery(id(), m_searchQuery, navigationId, m_filterState);
+
+    // results of location-aware scopes depend on where the search was made from
+    try {
+        if (m_locationService && m_settingsModel && m_scopeMetadata && m_scopeMetadata->location_data_needed())
+        {
+            QVariant locationEnabled = m_settingsModel->value(QStringLiteral("internal.location"));
+            if (locationEnabled.type() == QVariant::Bool && locationEnabled.toBool())
+            {
+                const scopes::Location location = m_locationService->location();
+                return SearchCache::locationKey(key, location.latitude(), location.longitude());
+            }
+        }
+    }
+    catch (std::domain_error& e)
+    {
+    }
+    return key;
+}
+
+void Scope::invalidateSearchCache()
+{
+    m_departmentPrefetcher->cancel();
+    m_searchCache.clear();
+    m_displayedSearchKey.clear();
+}
+
+qint64 Scope::memoryUsage() const
+{
+    // displayed results are shared with the cached search they came from
+    qint64 size = m_searchCache.memoryUsage();
+    if (m_displayedSearchKey.isEmpty() || !m_searchCache.contains(m_displayedSearchKey)) {
+        size += m_categories->memoryUsage();
+    }
+    return size;
+}
+
+bool Scope::hibernated() const
+{
+    return m_hibernated;
+}
+
+qint64 Scope::lastViewed() const
+{
+    return m_isActive ? QDateTime::currentMSecsSinceEpoch() : m_lastViewed;
+}
+
+void Scope::hibernate()
+{
+    if (m_isActive || m_hibernated || !m_initialQueryDone) {
+        return;
+    }
+
+    const qint64 usage = memoryUsage();
+
+    // the displayed search is the snapshot we restore from; other cached searches are dropped
+    CachedSearch displayed;
+    if (!m_displayedSearchKey.isEmpty() && m_searchCache.lookup(m_displayedSearchKey, displayed)) {
+        m_searchCache.trim(1);
+    } else {
+        m_searchCache.clear();
+    }
+
+    m_departmentPrefetcher->cancel();
+    invalidateLastSearch();
+    setSearchInProgress(false);
+    m_invalidateTimer.stop();
+
+    m_categories->clearAll();
+    m_departmentTree.reset();
+    m_rootDepartment.reset();
+    m_lastRootDepartment.reset();
+    // navigation models are deleted, they're rebuilt from the next department tree
+    Q_FOREACH(Department* navModel, m_departmentModels) {
+        releaseNavigationModel(navModel);
+    }
+    m_departmentModels.clear();
+    m_inverseDepartments.clear();
+    m_warmDepartmentModels.clear();
+
+    m_displayedSearchKey.clear();
+    m_hibernated = true;
+
+    qDebug() << id() << ": Hibernated, memory usage was" << usage << "bytes";
+
+    // next activation renders the snapshot (if any) or re-queries
+    if (!m_resultsDirty) {
+        m_resultsDirty = true;
+        Q_EMIT resultsDirtyChanged();
+    }
+}
+
+void Scope::setDepartmentPrefetchEnabled(bool enabled)
+{
+    m_departmentPrefetchEnabled = enabled;
+    if (!enabled) {
+        m_departmentPrefetcher->cancel();
+    }
+}
+
+bool Scope::departmentPrefetchEnabled() const
+{
+    return m_departmentPrefetchEnabled;
+}
+
+void Scope::prefetchSubdepartments()
+{
+    if (!m_departmentPrefetchEnabled || !m_proxy || !m_departmentTree || m_queryUserData || m_searchCache.capacity() == 0) {
+        return;
+    }
+
+    // results of scopes with short TTL expire soon, so don't prefetch as much for them
+    const int ttl = resultsTtl();
+    if (ttl <= 0) {
+        return;
+    }
+    const int limit = ttl < RESULTS_TTL_MEDIUM ? DEPARTMENT_PREFETCH_LIMIT / 2 : DEPARTMENT_PREFETCH_LIMIT;
+
+    DepartmentNode* node = m_departmentTree->findNodeById(m_currentNavigationId);
+    if (node == nullptr) {
+        return;
+    }
+
+    QList<DepartmentPrefetchRequest> requests;
+    Q_FOREACH(DepartmentNode* child, node->childNodes()) {
+        if (requests.size() >= limit) {
+            break;
+        }
+        DepartmentPrefetchRequest request { child->id(), searchCacheKey(child->id()) };
+        if (!m_searchCache.contains(request.cacheKey)) {
+            requests.append(request);
+        }
+    }
+
+    if (!requests.isEmpty()) {
+        m_departmentPrefetcher->prefetch(queryScheduler(), this, m_proxy, m_searchQuery, m_filterState, createSearchMetadata(), requests);
+    }
 }
 
 void Scope::setScopesInstance(Scopes* scopes)
@@ -652,17 +964,111 @@ void Scope::setScopesInstance(Scopes* scopes)
     if (m_scopesInstance) {
         m_metadataConnection = QObject::connect(scopes, &Scopes::metadataRefreshed, this, &Scope::metadataRefreshed);
         m_locationService = m_scopesInstance->locationService();
-        // TODO Notify the user the the location has changed
-        // connect(m_locationService.data(), &LocationService::locationChanged, this, &Scope::invalidateResults);
     }
 }
 
 void Scope::setSearchInProgress(bool searchInProgress)
 {
+    const bool wasRunning = searchRunning();
     if (m_searchInProgress != searchInProgress) {
         m_searchInProgress = searchInProgress;
         Q_EMIT searchInProgressChanged();
     }
+    searchRunningUpdated(wasRunning);
+}
+
+void Scope::setRevalidating(bool revalidating)
+{
+    const bool wasRunning = searchRunning();
+    m_revalidating = revalidating;
+    searchRunningUpdated(wasRunning);
+}
+
+void Scope::searchRunningUpdated(bool wasRunning)
+{
+    const bool running = searchRunning();
+    if (running != wasRunning) {
+        Q_EMIT searchRunningChanged();
+    }
+
+    if (!running && m_isActive) {
+        if (QueryScheduler* scheduler = queryScheduler()) {
+            scheduler->endInteractive(this);
+        }
+    }
+}
+
+bool Scope::searchRunning() const
+{
+    return m_searchInProgress || m_revalidating;
+}
+
+void Scope::revalidateResults()
+{
+    m_revalidationRequested = true;
+    dispatchSearch(true);
+}
+
+void Scope::refreshForLocation()
+{
+    if (!m_scopeMetadata || !m_scopeMetadata->location_data_needed() || !m_settingsModel) {
+        return;
+    }
+    QVariant locationEnabled = m_settingsModel->value(QStringLiteral("internal.location"));
+    if (locationEnabled.type() != QVariant::Bool || !locationEnabled.toBool()) {
+        return;
+    }
+
+    qDebug() << id() << ": Location changed, active:" << m_isActive;
+
+    // cached searches were done for the previous location
+    invalidateSearchCache();
+
+    if (!m_initialQueryDone) {
+        return;
+    }
+    if (m_isActive) {
+        // keep showing the current results while searching; location-aware scopes are coalesced by the scheduler
+        QueryScheduler* scheduler = queryScheduler();
+        if (scheduler) {
+            scheduler->schedule(this, QueryScheduler::Priority::TtlRefresh, [this]() { revalidateResults(); });
+        } else {
+            revalidateResults();
+        }
+    } else {
+        invalidateResults();
+    }
+}
+
+void Scope::initialLocationReady()
+{
+    if (!m_searchAfterLocation) {
+        return;
+    }
+    m_searchAfterLocation = false;
+
+    QueryScheduler* scheduler = queryScheduler();
+    if (m_isActive || !scheduler) {
+        dispatchSearch(m_searchAfterLocationProgrammatic);
+    } else {
+        scheduler->schedule(this, QueryScheduler::Priority::VisibleNeighbour, [this]() { dispatchSearch(true); });
+    }
+}
+
+void Scope::cancelSearch()
+{
+    invalidateLastSearch();
+    setSearchInProgress(false);
+}
+
+qint64 Scope::averageSearchLatency() const
+{
+    return m_searchLatency;
+}
+
+QueryScheduler* Scope::queryScheduler() const
+{
+    return m_scopesInstance ? m_scopesInstance->queryScheduler() : nullptr;
 }
 
 void Scope::setActivationInProgress(bool activationInProgress)
@@ -698,14 +1104,56 @@ void Scope::setFilterState(scopes::FilterState const& filterState)
 
 void Scope::dispatchSearch(bool programmaticSearch)
 {
+    if (m_scopeMetadata && m_scopeMetadata->location_data_needed() && m_scopesInstance
+            && m_scopesInstance->waitingForInitialLocation())
+    {
+        // searching without the location would only give results that get replaced in a moment
+        qDebug() << id() << ": Search held back until the initial location is known";
+        m_initialQueryDone = true;
+        m_searchAfterLocation = true;
+        m_searchAfterLocationProgrammatic = programmaticSearch;
+        if (m_isActive) {
+            setSearchInProgress(true);
+        }
+        return;
+    }
+    m_searchAfterLocation = false;
+
+    if (!m_scopeMetadata && !m_scopeSnapshot.id.isEmpty())
+    {
+        // created from the metadata snapshot and not discovered yet; setScopeData() dispatches the search
+        m_initialQueryDone = true;
+        if (m_isActive) {
+            setSearchInProgress(true);
+        }
+        return;
+    }
+
     m_initialQueryDone = true;
+    m_hibernated = false;
+
+    const bool revalidation = m_revalidationRequested;
+    m_revalidationRequested = false;
 
     invalidateLastSearch();
+
+    if (QueryScheduler* scheduler = queryScheduler()) {
+        scheduler->unschedule(this);
+        if (m_isActive && !revalidation) {
+            scheduler->beginInteractive(this);
+        }
+    }
+
     m_delayedSearchProcessing = true;
     m_category_results.clear();
     m_categories->markNewSearch();
 
-    m_searchProcessingDelayTimer.start(SEARCH_PROCESSING_DELAY);
+    // a revalidation keeps the current results until the new result set is complete
+    if (revalidation) {
+        setRevalidating(true);
+    } else {
+        m_searchProcessingDelayTimer.start(SEARCH_PROCESSING_DELAY);
+    }
     /* There are a few objects associated with searches:
      * 1) SearchResultReceiver    2) ResultCollector    3) PushEvent
      *
@@ -730,10 +1178,22 @@ void Scope::dispatchSearch(bool programmaticSearch)
         resultsDirtyChanged();
     }
 
-    setSearchInProgress(true);
+    // searches with user data attached to the query are never cached
+    m_departmentPrefetcher->cancel();
+    m_searchCacheKey = m_queryUserData ? QString() : searchCacheKey(m_currentNavigationId);
+    if (processCachedSearch()) {
+        setRevalidating(false);
+        setSearchInProgress(false);
+        return;
+    }
+    m_displayedSearchKey.clear();
+
+    if (!m_revalidating) {
+        setSearchInProgress(true);
+    }
 
-    // If applicable, update this scope's child scopes now, as part of the search process
-    // (i.e. while the loading bar is visible).
+    // If applicable, update this scope's child scopes now; they are queried in the background
+    // and don't hold up the search.
     update_child_scopes();
 
     // handle the case where single scope is refreshed multiple times without switching
@@ -751,30 +1211,7 @@ void Scope::dispatchSearch(bool programmaticSearch)
     }
 
     if (m_proxy) {
-        scopes::SearchMetadata meta(m_cardinality, QLocale::system().name().toStdString(), m_formFactor.toStdString());
-        auto const userAgent = m_scopesInstance->userAgentString();
-        if (!userAgent.isEmpty()) {
-            meta["user-agent"] = userAgent.toStdString();
-        }
-
-        if (!m_session_id.isNull()) {
-            meta["session-id"] = uuidToString(m_session_id).toStdString();
-        }
-        meta["query-id"] = unity::scopes::Variant(m_query_id);
-        try {
-            if (m_settingsModel && m_scopeMetadata && m_scopeMetadata->location_data_needed())
-            {
-                QVariant locationEnabled = m_settingsModel->value(QStringLiteral("internal.location"));
-                if (locationEnabled.type() == QVariant::Bool && locationEnabled.toBool())
-                {
-                    meta.set_location(m_locationService->location());
-                }
-            }
-        }
-        catch (std::domain_error& e)
-        {
-        }
-        meta.set_internet_connectivity(m_network_manager.isOnline() ? scopes::SearchMetadata::Connected : scopes::SearchMetadata::Disconnected);
+        scopes::SearchMetadata meta(createSearchMetadata());
 
         scopes::SearchListenerBase::SPtr listener(new SearchResultReceiver(this));
         m_searchController->setListener(listener);
@@ -794,24 +1231,78 @@ void Scope::dispatchSearch(bool programmaticSearch)
 
     if (!m_searchController->isValid()) {
         // something went wrong, reset search state
+        setRevalidating(false);
         setSearchInProgress(false);
     }
 }
 
+scopes::SearchMetadata Scope::createSearchMetadata()
+{
+    scopes::SearchMetadata meta(m_cardinality, QLocale::system().name().toStdString(), m_formFactor.toStdString());
+    auto const userAgent = m_scopesInstance->userAgentString();
+    if (!userAgent.isEmpty()) {
+        meta["user-agent"] = userAgent.toStdString();
+    }
+
+    if (!m_session_id.isNull()) {
+        meta["session-id"] = uuidToString(m_session_id).toStdString();
+    }
+    meta["query-id"] = unity::scopes::Variant(m_query_id);
+    try {
+        if (m_settingsModel && m_scopeMetadata && m_scopeMetadata->location_data_needed())
+        {
+            QVariant locationEnabled = m_settingsModel->value(QStringLiteral("internal.location"));
+            if (locationEnabled.type() == QVariant::Bool && locationEnabled.toBool())
+            {
+                meta.set_location(m_locationService->location());
+            }
+        }
+    }
+    catch (std::domain_error& e)
+    {
+    }
+    meta.set_internet_connectivity(m_network_manager.isOnline() ? scopes::SearchMetadata::Connected : scopes::SearchMetadata::Disconnected);
+    return meta;
+}
+
 void Scope::setScopeData(scopes::ScopeMetadata const& data)
 {
+    // scope created from the metadata snapshot could have been activated before we had its proxy
+    const bool pendingSearch = !m_proxy && m_initialQueryDone;
+
     m_scopeMetadata = std::make_shared<scopes::ScopeMetadata>(data);
     m_proxy = data.proxy();
+    m_scopeSnapshot = ScopeSnapshot();
 
     QVariant converted(scopeVariantToQVariant(scopes::Variant(m_scopeMetadata->appearance_attributes())));
     m_customizations = converted.toMap();
     Q_EMIT customizationsChanged();
 
+    if (qEnvironmentVariableIsSet("UNITY_SCOPES_DEPARTMENT_PREFETCH")) {
+        const QStringList scopeIds = QString::fromUtf8(qgetenv("UNITY_SCOPES_DEPARTMENT_PREFETCH")).split(QLatin1Char(','), QString::SkipEmptyParts);
+        setDepartmentPrefetchEnabled(scopeIds.contains(id()));
+    }
+
     createSettingsModel();
+
+    if (pendingSearch) {
+        invalidateResults();
+    }
+}
+
+void Scope::setScopeSnapshot(ScopeSnapshot const& snapshot)
+{
+    m_scopeSnapshot = snapshot;
+    m_customizations = snapshot.customizations;
+    Q_EMIT customizationsChanged();
 }
 
 void Scope::createSettingsModel()
 {
+    if (!m_scopeMetadata) {
+        return;
+    }
+
     try
     {
         scopes::Variant settings_definitions;
@@ -834,7 +1325,10 @@ void Scope::createSettingsModel()
                         !m_scopesInstance->locationAccessHelper()->isLocationAccessDenied(),
                         this));
 
-        QObject::connect(m_settingsModel.data(), &SettingsModel::settingsChanged, [this]() { invalidateResults(); });
+        QObject::connect(m_settingsModel.data(), &SettingsModel::settingsChanged, [this]() {
+            invalidateSearchCache();
+            invalidateResults();
+        });
 
         // If the scope needs location, then changes to global location access need to be monitored.
         if (m_scopeMetadata->location_data_needed()) {
@@ -846,17 +1340,18 @@ void Scope::createSettingsModel()
         // If there's no settings data
         m_settingsModel.reset();
     }
+    invalidateSearchCache();
     Q_EMIT settingsChanged();
 }
 
 QString Scope::id() const
 {
-    return QString::fromStdString(m_scopeMetadata ? m_scopeMetadata->scope_id() : "");
+    return m_scopeMetadata ? QString::fromStdString(m_scopeMetadata->scope_id()) : m_scopeSnapshot.id;
 }
 
 QString Scope::name() const
 {
-    return QString::fromStdString(m_scopeMetadata ? m_scopeMetadata->display_name() : "");
+    return m_scopeMetadata ? QString::fromStdString(m_scopeMetadata->display_name()) : m_scopeSnapshot.name;
 }
 
 QString Scope::iconHint() const
@@ -865,6 +1360,8 @@ QString Scope::iconHint() const
     try {
         if (m_scopeMetadata) {
             icon = m_scopeMetadata->icon();
+        } else {
+            return m_scopeSnapshot.icon;
         }
     } catch (...) {
         // throws if the value isn't set, safe to ignore
@@ -875,7 +1372,7 @@ QString Scope::iconHint() const
 
 QString Scope::description() const
 {
-    return QString::fromStdString(m_scopeMetadata ? m_scopeMetadata->description() : "");
+    return m_scopeMetadata ? QString::fromStdString(m_scopeMetadata->description()) : m_scopeSnapshot.description;
 }
 
 QString Scope::searchHint() const
@@ -884,6 +1381,8 @@ QString Scope::searchHint() const
     try {
         if (m_scopeMetadata) {
             search_hint = m_scopeMetadata->search_hint();
+        } else {
+            return m_scopeSnapshot.searchHint;
         }
     } catch (...) {
         // throws if the value isn't set, safe to ignore
@@ -918,6 +1417,8 @@ QString Scope::shortcut() const
     try {
         if (m_scopeMetadata) {
             hotkey = m_scopeMetadata->hot_key();
+        } else {
+            return m_scopeSnapshot.shortcut;
         }
     } catch (...) {
         // throws if the value isn't set, safe to ignore
@@ -957,8 +1458,8 @@ bool Scope::require_child_scopes_refresh() const
 
 void Scope::update_child_scopes()
 {
-    // only run the update if child scopes have changed
-    if (m_childScopesDirty && m_settingsModel && m_scopesInstance)
+    // only run the update if child scopes have changed; scopes restored from the snapshot don't know their proxy yet
+    if (m_childScopesDirty && m_scopeMetadata && m_settingsModel && m_scopesInstance)
     {
         // reset the flag so that re-entering this method won't restart the update unnecessarily
         m_childScopesDirty = false;
@@ -974,15 +1475,30 @@ unity::shell::scopes::NavigationInterface* Scope::getNavigation(QString const& n
     DepartmentNode* node = m_departmentTree->findNodeById(navId);
     if (!node) return nullptr;
 
-    Department* navModel = new Department;
-    navModel->setScopeId(this->id());
-    navModel->loadFromDepartmentNode(node);
+    // models are shared; live ones are kept up to date by updateNavigationModels()
+    Department* navModel = m_departmentModels.value(navId, nullptr);
+    if (navModel == nullptr) {
+        navModel = new Department;
+        navModel->setScopeId(this->id());
+        navModel->loadFromDepartmentNode(node);
+
+        QQmlEngine::setObjectOwnership(navModel, QQmlEngine::CppOwnership);
+
+        // sharing m_inverseDepartments with getAltNavigation
+        m_departmentModels.insert(navId, navModel);
+        m_inverseDepartments.insert(navModel, navId);
+        QObject::connect(navModel, &QObject::destroyed, this, &Scope::departmentModelDestroyed);
+    }
     navModel->markSubdepartmentActive(m_currentNavigationId);
 
-    // sharing m_inverseDepartments with getAltNavigation
-    m_departmentModels.insert(navId, navModel);
-    m_inverseDepartments.insert(navModel, navId);
-    QObject::connect(navModel, &QObject::destroyed, this, &Scope::departmentModelDestroyed);
+    // keep the recently used models, release the least recently used one
+    m_warmDepartmentModels.removeOne(navModel);
+    m_warmDepartmentModels.append(navModel);
+    if (m_warmDepartmentModels.size() > NAVIGATION_CACHE_SIZE) {
+        Department* oldest = m_warmDepartmentModels.takeFirst();
+        m_departmentModels.remove(m_inverseDepartments.take(oldest));
+        releaseNavigationModel(oldest);
+    }
 
     return navModel;
 }
@@ -1009,8 +1525,9 @@ void Scope::departmentModelDestroyed(QObject* obj)
     auto it = m_inverseDepartments.find(navigation);
     if (it == m_inverseDepartments.end()) return;
 
-    m_departmentModels.remove(it.value(), navigation);
+    m_departmentModels.remove(it.value());
     m_inverseDepartments.erase(it);
+    m_warmDepartmentModels.removeOne(navigation);
 }
 
 void Scope::previewModelDestroyed(QObject *obj)
@@ -1038,6 +1555,7 @@ void Scope::performQuery(QString const& cannedQuery)
 void Scope::refresh()
 {
     // shell has to specifically call this, maybe we should ignore the active flag here and just call dispatchSearch
+    invalidateSearchCache();
     invalidateResults();
 }
 
@@ -1117,8 +1635,14 @@ void Scope::setSearchQueryString(const QString& search_query)
         }
         m_searchQuery = search_query;
 
+        // user is typing, prefetched departments are not going to be needed
+        m_departmentPrefetcher->cancel();
+
         // only use typing delay if scope is active, otherwise apply immediately
         if (m_isActive) {
+            if (QueryScheduler* scheduler = queryScheduler()) {
+                scheduler->beginInteractive(this);
+            }
             m_typingTimer.start();
         } else {
             invalidateResults();
@@ -1137,6 +1661,7 @@ void Scope::setNoResultsHint(const QString& hint) {
 void Scope::setFormFactor(const QString& form_factor) {
     if (form_factor != m_formFactor) {
         m_formFactor = form_factor;
+        invalidateSearchCache();
         // FIXME: force new search
         Q_EMIT formFactorChanged();
     }
@@ -1147,6 +1672,7 @@ void Scope::setActive(const bool active) {
 
     if (active != m_isActive) {
         m_isActive = active;
+        m_lastViewed = QDateTime::currentMSecsSinceEpoch();
         Q_EMIT isActiveChanged();
 
         if (m_scopeMetadata && m_scopeMetadata->location_data_needed())
@@ -1157,6 +1683,20 @@ void Scope::setActive(const bool active) {
             }
         }
 
+        if (active) {
+            m_hibernationTimer.stop();
+        } else if (m_initialQueryDone && m_hibernationTimer.interval() > 0) {
+            m_hibernationTimer.start();
+        }
+
+        if (QueryScheduler* scheduler = queryScheduler()) {
+            if (active) {
+                scheduler->promote(this);
+            } else {
+                scheduler->endInteractive(this);
+            }
+        }
+
         if (active && m_resultsDirty) {
             dispatchSearch();
         }
@@ -1242,6 +1782,7 @@ void Scope::activate(QVariant const& result_var, QString const& categoryId)
                         case scopes::OnlineAccountClient::DoNothing:
                             return;
                         case scopes::OnlineAccountClient::InvalidateResults:
+                            invalidateSearchCache();
                             invalidateResults();
                             return;
                         default:
@@ -1321,13 +1862,25 @@ void Scope::invalidateResults(bool programmaticSearch)
 {
     qDebug() << id() << ": results invalidated, programmatic:" << programmaticSearch << ", active:" << m_isActive;
 
+    // programmatic invalidation means the scope itself (or the registry) changed
+    if (programmaticSearch) {
+        invalidateSearchCache();
+    }
+
     // If it's a programmatic invalidation (due to scope registry changes for example) and the trusted prompt was never shown before,
     // then dispatch search even if scope is not currently active; just setting 'dirty' flag is problematic because when the scope
     // becomes active we won't know if it was because of programmatic search.
     bool firstBoot = (m_scopesInstance != nullptr && !m_scopesInstance->locationAccessHelper()->trustedPromptWasShown());
 
-    if (m_isActive || (programmaticSearch && firstBoot)) {
+    QueryScheduler* scheduler = queryScheduler();
+    if (m_isActive) {
         dispatchSearch(programmaticSearch);
+    } else if (programmaticSearch && firstBoot) {
+        if (scheduler) {
+            scheduler->schedule(this, QueryScheduler::Priority::ProgrammaticRefresh, [this]() { dispatchSearch(true); });
+        } else {
+            dispatchSearch(true);
+        }
     } else {
         // mark the results as dirty, so next setActive() re-sends the query
         if (!m_resultsDirty)
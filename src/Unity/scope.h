@@ -29,6 +29,8 @@
 #include <QNetworkConfigurationManager>
 #include <QPointer>
 #include <QMultiMap>
+#include <QHash>
+#include <QSet>
 #include <QUuid>
 
 // scopes
@@ -44,6 +46,10 @@
 #include "department.h"
 #include "ubuntulocationservice.h"
 #include "locationaccesshelper.h"
+#include "searchcache.h"
+#include "departmentprefetcher.h"
+#include "metadatasnapshot.h"
+#include "queryscheduler.h"
 
 namespace scopes_ng
 {
@@ -164,6 +170,8 @@ public:
     Q_INVOKABLE void resetFilters() override;
 
     void setScopeData(unity::scopes::ScopeMetadata const& data);
+    // display data used until setScopeData() is called
+    void setScopeSnapshot(ScopeSnapshot const& snapshot);
     void handleActivation(std::shared_ptr<unity::scopes::ActivationResponse> const&, unity::scopes::Result::SPtr const&, QString const& categoryId="");
     void activateUri(QString const& uri);
     void activateAction(QVariant const& result, QString const& categoryId, QString const& actionId) override;
@@ -179,9 +187,39 @@ public:
 
     void setSearchQueryString(const QString& search_query);
 
+    // drop cached results of previous searches, e.g. when the scope data they depend on changed
+    void invalidateSearchCache();
+
+    // prefetch subdepartments of the current department in background after searches finish
+    void setDepartmentPrefetchEnabled(bool enabled);
+    bool departmentPrefetchEnabled() const;
+
+    // estimated memory used by results of this scope, in bytes
+    qint64 memoryUsage() const;
+    bool hibernated() const;
+    // time the scope was last active, in ms since epoch; 0 if never
+    qint64 lastViewed() const;
+    // average duration of searches of this scope in ms; -1 if not known yet
+    qint64 averageSearchLatency() const;
+
+    void cancelSearch();
+    // true while a search is running, including background revalidations which don't
+    // set searchInProgress
+    bool searchRunning() const;
+    // re-runs the current search in the background; results displayed so far stay visible
+    // until the new result set is complete
+    void revalidateResults();
+    // the location moved significantly; re-run the search if it depends on the location
+    void refreshForLocation();
+    // the startup wait for the location finished; dispatch the search held back by it, if any
+    void initialLocationReady();
+
     const QNetworkConfigurationManager& networkManager() const;
 
 public Q_SLOTS:
+    // release result models and department tree of an inactive scope, keeping only the displayed
+    // search cached, so it can be restored when the scope becomes active again
+    void hibernate();
     void invalidateChildScopes();
     void invalidateResults(bool programmaticSearch = false);
     virtual void dispatchSearch(bool programmaticSearch = false);
@@ -193,6 +231,7 @@ Q_SIGNALS:
     void favoriteChanged(bool);
     void activationFailed(QString const& id);
     void updateResultRequested();
+    void searchRunningChanged();
 
 private Q_SLOTS:
     void typingFinished();
@@ -216,10 +255,20 @@ protected:
     QPointer<Scopes> m_scopesInstance;
 
 private:
-    static void updateNavigationModels(DepartmentNode* rootNode, QMultiMap<QString, Department*>& navigationModels, QString const& activeNavigation);
+    void reloadNavigationModels();
+    void releaseNavigationModel(Department* navModel);
+    static void updateNavigationModels(DepartmentNode* rootNode, QHash<QString, Department*>& navigationModels, QString const& activeNavigation, QSet<QString> const& changedNodes);
     static QString buildQuery(QString const& scopeId, QString const& searchQuery, QString const& departmentId, unity::scopes::FilterState const& filterState);
     void setScopesInstance(Scopes*);
+    int resultsTtl() const;
     void startTtlTimer();
+    void setRevalidating(bool revalidating);
+    void searchRunningUpdated(bool wasRunning);
+    QueryScheduler* queryScheduler() const;
+    bool processCachedSearch();
+    QString searchCacheKey(QString const& navigationId) const;
+    void prefetchSubdepartments();
+    unity::scopes::SearchMetadata createSearchMetadata();
     void setCurrentNavigationId(QString const& id);
     void setFilterState(unity::scopes::FilterState const& filterState);
     void processSearchChunk(PushEvent* pushEvent);
@@ -246,6 +295,10 @@ private:
     int m_activeFiltersCount;
     bool m_isActive;
     bool m_searchInProgress;
+    bool m_revalidating;
+    bool m_revalidationRequested;
+    bool m_searchAfterLocation;
+    bool m_searchAfterLocationProgrammatic;
     bool m_activationInProgress;
     bool m_resultsDirty;
     bool m_delayedSearchProcessing;
@@ -261,6 +314,7 @@ private:
     std::unique_ptr<CollectionController> m_activationController;
     unity::scopes::ScopeProxy m_proxy;
     unity::scopes::ScopeMetadata::SPtr m_scopeMetadata;
+    ScopeSnapshot m_scopeSnapshot;
     std::shared_ptr<unity::scopes::ActivationResponse> m_delayedActivation;
     unity::scopes::Department::SCPtr m_rootDepartment;
     unity::scopes::Department::SCPtr m_lastRootDepartment;
@@ -275,8 +329,19 @@ private:
     QTimer m_searchProcessingDelayTimer;
     QTimer m_invalidateTimer;
     QList<std::shared_ptr<unity::scopes::CategorisedResult>> m_cachedResults;
-    QMultiMap<QString, Department*> m_departmentModels;
+    QList<std::shared_ptr<unity::scopes::CategorisedResult>> m_searchResults;
+    SearchCache m_searchCache;
+    QString m_searchCacheKey;
+    QString m_displayedSearchKey;
+    QScopedPointer<DepartmentPrefetcher> m_departmentPrefetcher;
+    bool m_departmentPrefetchEnabled;
+    bool m_hibernated;
+    qint64 m_lastViewed;
+    qint64 m_searchLatency;
+    QTimer m_hibernationTimer;
+    QHash<QString, Department*> m_departmentModels; // one shared model per navigation id
     QMap<Department*, QString> m_inverseDepartments;
+    QList<Department*> m_warmDepartmentModels; // all models by last use, least recently used first
     QMetaObject::Connection m_metadataConnection;
     QSharedPointer<UbuntuLocationService> m_locationService;
     QSharedPointer<UbuntuLocationService::Token> m_locationToken;
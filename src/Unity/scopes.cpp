@@ -25,6 +25,8 @@
 #include "overviewscope.h"
 #include "ubuntulocationservice.h"
 #include "favorites.h"
+#include "metadatasnapshot.h"
+#include "queryscheduler.h"
 
 // Qt
 #include <QDebug>
@@ -36,6 +38,8 @@
 #include <QUrlQuery>
 #include <QTextStream>
 
+#include <algorithm>
+
 #include <unity/scopes/Registry.h>
 #include <unity/scopes/Scope.h>
 #include <unity/scopes/ScopeProxyFwd.h>
@@ -60,6 +64,10 @@ void ScopeListWorker::run()
         }
         auto registry = m_scopesRuntime->registry();
         m_metadataMap = registry->list();
+        // written here rather than in the UI thread; the snapshot is only read on next startup
+        if (!m_snapshotPath.isEmpty()) {
+            MetadataSnapshot::save(m_snapshotPath, m_metadataMap);
+        }
     }
     catch (std::exception const& err)
     {
@@ -73,6 +81,11 @@ void ScopeListWorker::setRuntimeConfig(QString const& config)
     m_runtimeConfig = config;
 }
 
+void ScopeListWorker::setSnapshotPath(QString const& path)
+{
+    m_snapshotPath = path;
+}
+
 void ScopeListWorker::setRuntime(scopes::Runtime::SPtr const& runtime)
 {
     m_scopesRuntime = runtime;
@@ -91,6 +104,9 @@ scopes::MetadataMap ScopeListWorker::metadataMap() const
 int Scopes::LIST_DELAY = -1;
 const int Scopes::SCOPE_DELETE_DELAY = 3;
 const int LOCATION_STARTUP_TIMEOUT = 1000;
+const int MEMORY_BUDGET_MB = 64; // default budget for results held by all scopes
+const int MEMORY_BUDGET_CHECK_DELAY = 500;
+const int MAX_CONCURRENT_QUERIES = 2; // maximum number of scheduled (non-interactive) searches running at the same time
 
 class Scopes::Priv : public QObject {
     Q_OBJECT
@@ -107,9 +123,17 @@ Scopes::Scopes(QObject *parent)
     , m_listThread(nullptr)
     , m_loaded(false)
     , m_prepopulateFirstScope(true)
+    , m_populatedFromSnapshot(false)
+    , m_finishedStartupPhases(0)
+    , m_metadataRefreshPending(false)
+    , m_memoryBudget(0)
+    , m_memoryUsage(0)
+    , m_snapshotPath(MetadataSnapshot::defaultPath())
     , m_locationAccessHelper(new LocationAccessHelper(nullptr))
     , m_priv(new Priv())
 {
+    m_startupTimer.start();
+
     QByteArray noFav = qgetenv("UNITY_SCOPES_NO_FAVORITES");
     if (!noFav.isNull()) {
         m_noFavorites = true;
@@ -124,11 +148,34 @@ Scopes::Scopes(QObject *parent)
             SLOT(invalidateScopeResults(const QString &)), Qt::QueuedConnection);
 
     QDBusConnection::sessionBus().connect(QString(), QStringLiteral("/com/canonical/unity/scopes"), QStringLiteral("com.canonical.unity.scopes"), QStringLiteral("InvalidateResults"), this, SLOT(invalidateScopeResults(QString)));
+    QDBusConnection::sessionBus().connect(QString(), QStringLiteral("/com/canonical/unity/scopes"), QStringLiteral("com.canonical.unity.scopes"), QStringLiteral("LowMemory"), this, SLOT(hibernateInactiveScopes()));
 
     m_dashSettings = QGSettings::isSchemaInstalled("com.canonical.Unity.Dash") ? new QGSettings("com.canonical.Unity.Dash", QByteArray(), this) : nullptr;
     m_favoriteScopes = new Favorites(this, m_dashSettings);
     QObject::connect(m_favoriteScopes, &Favorites::favoritesChanged, this, &Scopes::favoritesChanged);
 
+    m_queryScheduler = new QueryScheduler(qEnvironmentVariableIsSet("UNITY_SCOPES_MAX_CONCURRENT_QUERIES") ?
+            qgetenv("UNITY_SCOPES_MAX_CONCURRENT_QUERIES").toInt() : MAX_CONCURRENT_QUERIES, this);
+
+    m_memoryBudgetTimer.setSingleShot(true);
+    m_memoryBudgetTimer.setInterval(MEMORY_BUDGET_CHECK_DELAY);
+    connect(&m_memoryBudgetTimer, SIGNAL(timeout()), this, SLOT(enforceMemoryBudget()));
+
+    // memory budget is configured in megabytes; the environment takes precedence over dash settings
+    const bool budgetFromSettings = !qEnvironmentVariableIsSet("UNITY_SCOPES_MEMORY_BUDGET") && m_dashSettings &&
+        m_dashSettings->keys().contains(QStringLiteral("resultsMemoryBudget"));
+    if (budgetFromSettings) {
+        setMemoryBudget(m_dashSettings->get(QStringLiteral("resultsMemoryBudget")).toLongLong() * 1024 * 1024);
+        connect(m_dashSettings, &QGSettings::changed, this, [this](QString const& key) {
+            if (key == QLatin1String("resultsMemoryBudget")) {
+                setMemoryBudget(m_dashSettings->get(key).toLongLong() * 1024 * 1024);
+            }
+        });
+    } else {
+        const QByteArray budget = qgetenv("UNITY_SCOPES_MEMORY_BUDGET");
+        setMemoryBudget((budget.isNull() ? MEMORY_BUDGET_MB : budget.toLongLong()) * 1024 * 1024);
+    }
+
     m_overviewScope = OverviewScope::newInstance(this);
 
     m_registryRefreshTimer.setSingleShot(true);
@@ -139,9 +186,16 @@ Scopes::Scopes(QObject *parent)
     QObject::connect(m_locationService.data(), &UbuntuLocationService::accessDenied, m_locationAccessHelper.data(), &LocationAccessHelper::accessDenied);
     QObject::connect(m_locationService.data(), &UbuntuLocationService::locationChanged, m_locationAccessHelper.data(), &LocationAccessHelper::positionChanged);
     QObject::connect(m_locationService.data(), &UbuntuLocationService::geoIpLookupFinished, m_locationAccessHelper.data(), &LocationAccessHelper::geoIpLookupFinished);
+    QObject::connect(m_locationService.data(), &UbuntuLocationService::requeryNeeded, this, &Scopes::locationRequeryNeeded);
     m_locationAccessHelper->init();
 
+    // scopes pick up the location service when they're created, so it has to exist by now
+    populateScopesFromSnapshot();
+
+    // user agent, registry listing and initial location are independent, so run them concurrently
     createUserAgentString();
+    initPopulateScopes();
+    waitForInitialLocation();
 
     m_scopesToDeleteTimer.setSingleShot(true);
     m_scopesToDeleteTimer.setInterval(1000 * SCOPE_DELETE_DELAY);
@@ -164,6 +218,7 @@ QString Scopes::userAgentString() const
 void Scopes::purgeScopesToDelete()
 {
     m_scopesToDelete.clear();
+    scheduleMemoryBudgetCheck();
 }
 
 QSharedPointer<LocationAccessHelper> Scopes::locationAccessHelper() const
@@ -187,12 +242,17 @@ void Scopes::createUserAgentString()
 {
     QProcess *lsb_release = new QProcess(this);
     connect(lsb_release, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(lsbReleaseFinished()));
-    connect(lsb_release, SIGNAL(error(QProcess::ProcessError)), this, SLOT(initPopulateScopes()));
+    connect(lsb_release, SIGNAL(error(QProcess::ProcessError)), this, SLOT(lsbReleaseFinished()));
     lsb_release->start(QStringLiteral("lsb_release -r"), QIODevice::ReadOnly);
 }
 
 void Scopes::lsbReleaseFinished()
 {
+    // a crashed process reports both error() and finished()
+    if (m_finishedStartupPhases & UserAgentPhase) {
+        return;
+    }
+
     QProcess *lsb_release = qobject_cast<QProcess *>(sender());
     if (lsb_release) {
         const QString out = lsb_release->readAllStandardOutput();
@@ -242,7 +302,7 @@ void Scopes::lsbReleaseFinished()
     m_userAgent = q.toString();
 
     qDebug() << "User agent string:" << m_userAgent;
-    initPopulateScopes();
+    startupPhaseFinished(UserAgentPhase);
 }
 
 QString Scopes::readPartnerId()
@@ -265,14 +325,45 @@ QString Scopes::readPartnerId()
     return partnerId;
 }
 
+void Scopes::populateScopesFromSnapshot()
+{
+    if (m_noFavorites || !m_dashSettings) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // create favorite scopes from the last known registry contents; they get their metadata
+    // (and proxies) in discoveryFinished(), and stale entries are removed by processFavoriteScopes()
+    const QMap<QString, ScopeSnapshot> snapshot = MetadataSnapshot::load(m_snapshotPath);
+    for (auto const& fv: m_favoriteScopes->getFavorites())
+    {
+        auto it = snapshot.constFind(fv);
+        if (it != snapshot.constEnd())
+        {
+            Scope::Ptr scope = Scope::newInstance(this, true);
+            connect(scope.data(), SIGNAL(isActiveChanged()), this, SLOT(prepopulateNextScopes()));
+            scope->setScopeSnapshot(it.value());
+            m_scopes.append(scope);
+        }
+    }
+
+    if (!m_scopes.isEmpty()) {
+        m_populatedFromSnapshot = true;
+        m_loaded = true;
+        qDebug() << "Populated" << m_scopes.size() << "scopes from metadata snapshot in" << timer.elapsed() << "ms";
+    }
+}
+
 void Scopes::initPopulateScopes()
 {
     // initiate scopes
-    // delaying spawning the worker thread, causes problems with qmlplugindump
-    // without it
+    // the worker thread must not be spawned from the constructor, that causes problems with qmlplugindump;
+    // deferring it to the event loop is enough, so don't hold up startup by default
     if (LIST_DELAY < 0) {
         QByteArray listDelay = qgetenv("UNITY_SCOPES_LIST_DELAY");
-        LIST_DELAY = listDelay.isNull() ? 100 : listDelay.toInt();
+        LIST_DELAY = listDelay.isNull() ? 0 : listDelay.toInt();
     }
     QTimer::singleShot(LIST_DELAY, this, SLOT(populateScopes()));
 }
@@ -284,6 +375,7 @@ void Scopes::populateScopes()
     auto thread = new ScopeListWorker;
     QByteArray runtimeConfig = qgetenv("UNITY_SCOPES_RUNTIME_PATH");
     thread->setRuntimeConfig(QString::fromLocal8Bit(runtimeConfig));
+    thread->setSnapshotPath(m_snapshotPath);
     QObject::connect(thread, &ScopeListWorker::discoveryFinished, this, &Scopes::discoveryFinished);
     QObject::connect(thread, &ScopeListWorker::finished, thread, &QObject::deleteLater);
 
@@ -315,67 +407,114 @@ void Scopes::discoveryFinished()
                             std::bind(&Scopes::Priv::safeInvalidateScopeResults,
                                       m_priv.get(), SCOPES_SCOPE_ID))));
 
-    beginResetModel();
-
-    if (m_noFavorites) {
-        // add all visible scopes
-        for (auto it = scopes.begin(); it != scopes.end(); ++it) {
-            if (!it->second.invisible()) {
-                Scope::Ptr scope = Scope::newInstance(this);
-                connect(scope.data(), SIGNAL(isActiveChanged()), this, SLOT(prepopulateNextScopes()));
-                scope->setScopeData(it->second);
-                m_scopes.append(scope);
-            }
-        }
-    }
-
-    // cache all the metadata
+    // cache all the metadata; scopes are created (or given their metadata) in completeDiscoveryFinished()
     m_cachedMetadata.clear();
     for (auto it = scopes.begin(); it != scopes.end(); ++it) {
         m_cachedMetadata[QString::fromStdString(it->first)] = std::make_shared<unity::scopes::ScopeMetadata>(it->second);
     }
 
-    if (m_locationService->hasLocation() || qEnvironmentVariableIsSet("UNITY_SCOPES_NO_WAIT_LOCATION"))
+    startupPhaseFinished(RegistryPhase);
+}
+
+void Scopes::waitForInitialLocation()
+{
+    // a GeoIP result cached by the previous session is good enough for the first searches
+    if (m_locationService->hasLocation() || m_locationService->hasGeoIpLocation()
+            || qEnvironmentVariableIsSet("UNITY_SCOPES_NO_WAIT_LOCATION"))
     {
-        // If we already have a location just query the scopes now
-        completeDiscoveryFinished();
+        startupPhaseFinished(LocationPhase);
+        return;
     }
-    else
-    {
-        qDebug() << "Waiting for initial location update";
 
-        // Otherwise we have to wait for location data
-        // Either the the location data needs to change, or the timeout happens
-        connect(m_locationService.data(), &UbuntuLocationService::locationChanged,
-                this, &Scopes::completeDiscoveryFinished);
-        connect(m_locationService.data(), &UbuntuLocationService::accessDenied,
-                this, &Scopes::completeDiscoveryFinished);
-        connect(m_locationService.data(), &UbuntuLocationService::locationTimeout,
-                this, &Scopes::completeDiscoveryFinished);
-        connect(&m_startupQueryTimeout, &QTimer::timeout, this,
-                &Scopes::completeDiscoveryFinished);
-        m_startupQueryTimeout.setSingleShot(true);
-        m_startupQueryTimeout.setInterval(LOCATION_STARTUP_TIMEOUT);
-        m_startupQueryTimeout.start();
-    }
+    qDebug() << "Waiting for initial location update";
+
+    // Either the the location data needs to change, or the timeout happens
+    connect(m_locationService.data(), &UbuntuLocationService::locationChanged,
+            this, &Scopes::locationPhaseFinished);
+    connect(m_locationService.data(), &UbuntuLocationService::accessDenied,
+            this, &Scopes::locationPhaseFinished);
+    connect(m_locationService.data(), &UbuntuLocationService::locationTimeout,
+            this, &Scopes::locationPhaseFinished);
+    connect(&m_startupQueryTimeout, &QTimer::timeout, this,
+            &Scopes::locationPhaseFinished);
+    m_startupQueryTimeout.setSingleShot(true);
+    m_startupQueryTimeout.setInterval(LOCATION_STARTUP_TIMEOUT);
+    m_startupQueryTimeout.start();
 }
 
-void Scopes::completeDiscoveryFinished()
+void Scopes::locationPhaseFinished()
 {
-    qDebug() << "Scopes discovery completed";
-    // Kill off everything that could potentially trigger the startup queries
+    // Kill off everything that could potentially finish the location phase again
     m_startupQueryTimeout.stop();
     disconnect(&m_startupQueryTimeout, &QTimer::timeout, this,
-               &Scopes::completeDiscoveryFinished);
+               &Scopes::locationPhaseFinished);
     disconnect(m_locationService.data(), &UbuntuLocationService::locationChanged,
-               this, &Scopes::completeDiscoveryFinished);
+               this, &Scopes::locationPhaseFinished);
     disconnect(m_locationService.data(), &UbuntuLocationService::accessDenied,
-               this, &Scopes::completeDiscoveryFinished);
+               this, &Scopes::locationPhaseFinished);
     disconnect(m_locationService.data(), &UbuntuLocationService::locationTimeout,
-               this, &Scopes::completeDiscoveryFinished);
+               this, &Scopes::locationPhaseFinished);
 
-    processFavoriteScopes();
-    endResetModel();
+    startupPhaseFinished(LocationPhase);
+}
+
+void Scopes::startupPhaseFinished(StartupPhase phase)
+{
+    if (m_finishedStartupPhases & phase) {
+        return;
+    }
+    m_finishedStartupPhases |= phase;
+
+    const char* name = phase == UserAgentPhase ? "user agent" : (phase == RegistryPhase ? "registry" : "location");
+    qDebug() << "Startup phase" << name << "finished after" << m_startupTimer.elapsed() << "ms";
+
+    if (phase == LocationPhase) {
+        // location-aware scopes held back their searches until now
+        Q_FOREACH(Scope::Ptr scope, m_scopes) {
+            scope->initialLocationReady();
+        }
+        Q_FOREACH(Scope::Ptr scope, m_tempScopes) {
+            scope->initialLocationReady();
+        }
+    } else if ((m_finishedStartupPhases & DiscoveryPhases) == DiscoveryPhases) {
+        completeDiscoveryFinished();
+    }
+}
+
+bool Scopes::waitingForInitialLocation() const
+{
+    return !(m_finishedStartupPhases & LocationPhase);
+}
+
+void Scopes::completeDiscoveryFinished()
+{
+    qDebug() << "Scopes discovery completed after" << m_startupTimer.elapsed() << "ms";
+
+    if (m_populatedFromSnapshot) {
+        // scopes created from the snapshot are kept and reconciled by processFavoriteScopes()
+        for (auto const& scope: m_scopes) {
+            auto it = m_cachedMetadata.constFind(scope->id());
+            if (it != m_cachedMetadata.constEnd()) {
+                scope->setScopeData(*(it.value()));
+            }
+        }
+        processFavoriteScopes();
+    } else {
+        beginResetModel();
+        if (m_noFavorites) {
+            // add all visible scopes
+            for (auto it = m_cachedMetadata.constBegin(); it != m_cachedMetadata.constEnd(); ++it) {
+                if (!it.value()->invisible()) {
+                    Scope::Ptr scope = Scope::newInstance(this);
+                    connect(scope.data(), SIGNAL(isActiveChanged()), this, SLOT(prepopulateNextScopes()));
+                    scope->setScopeData(*(it.value()));
+                    m_scopes.append(scope);
+                }
+            }
+        }
+        processFavoriteScopes();
+        endResetModel();
+    }
 
     m_loaded = true;
     Q_EMIT loadedChanged();
@@ -384,6 +523,9 @@ void Scopes::completeDiscoveryFinished()
     Q_EMIT metadataRefreshed();
 
     m_listThread = nullptr;
+    if (m_metadataRefreshPending) {
+        refreshScopeMetadata();
+    }
 
     if (m_prepopulateFirstScope) {
         m_prepopulateFirstScope = false;
@@ -399,7 +541,8 @@ void Scopes::prepopulateFirstScope()
             qDebug() << "Pre-populating first scope:" << scope->id();
             scope->setSearchQuery(QLatin1String(""));
             // must dispatch search explicitly since setSearchQuery will not do that for inactive scope
-            scope->dispatchSearch(true);
+            Scope* s = scope.data();
+            m_queryScheduler->schedule(s, QueryScheduler::Priority::VisibleNeighbour, [s]() { s->dispatchSearch(true); });
         }
     }
 }
@@ -416,7 +559,8 @@ void Scopes::prepopulateNextScopes()
                     qDebug() << "Pre-populating scope" << scope->id();
                     scope->setSearchQuery(QLatin1String(""));
                     // must dispatch search explicitly since setSearchQuery will not do that for inactive scope
-                    scope->dispatchSearch(true);
+                    Scope* s = scope.data();
+                    m_queryScheduler->schedule(s, QueryScheduler::Priority::VisibleNeighbour, [s]() { s->dispatchSearch(true); });
                 }
             }
             break;
@@ -428,7 +572,8 @@ void Scopes::processFavoriteScopes()
 {
     qDebug() << "Scopes::processFavoriteScopes()";
 
-    if (m_noFavorites) {
+    // the registry hasn't been listed yet (scopes may come from the snapshot), nothing to reconcile against
+    if (m_noFavorites || !m_scopesRuntime) {
         return;
     }
 
@@ -533,17 +678,166 @@ void Scopes::refreshFinished()
 
     auto scopes = thread->metadataMap();
 
-    // cache all the metadata
-    m_cachedMetadata.clear();
+    // diff with the cached metadata; unchanged ScopeMetadata objects are kept
+    QMap<QString, unity::scopes::ScopeMetadata::SPtr> metadata;
+    QSet<QString> modifiedScopes;
+    bool scopesInstalledOrRemoved = false;
     for (auto it = scopes.begin(); it != scopes.end(); ++it) {
-        m_cachedMetadata[QString::fromStdString(it->first)] = std::make_shared<unity::scopes::ScopeMetadata>(it->second);
+        const QString id = QString::fromStdString(it->first);
+        auto cached = m_cachedMetadata.constFind(id);
+        if (cached == m_cachedMetadata.constEnd()) {
+            metadata[id] = std::make_shared<unity::scopes::ScopeMetadata>(it->second);
+            scopesInstalledOrRemoved = true;
+        } else if (cached.value()->serialize() != it->second.serialize()) {
+            metadata[id] = std::make_shared<unity::scopes::ScopeMetadata>(it->second);
+            modifiedScopes.insert(id);
+        } else {
+            metadata[id] = cached.value();
+        }
     }
+    // all the remaining ids were cached already, so a size mismatch means some scopes were removed
+    if (metadata.size() != m_cachedMetadata.size()) {
+        scopesInstalledOrRemoved = true;
+    }
+    m_cachedMetadata = metadata;
 
     processFavoriteScopes();
 
+    if (!modifiedScopes.isEmpty() || scopesInstalledOrRemoved) {
+        qDebug() << "Scope metadata changed:" << modifiedScopes << "installed or removed:" << scopesInstalledOrRemoved;
+        Q_FOREACH(Scope::Ptr scope, m_scopes) {
+            updateScopeMetadata(scope, modifiedScopes, scopesInstalledOrRemoved);
+        }
+        Q_FOREACH(Scope::Ptr scope, m_tempScopes) {
+            updateScopeMetadata(scope, modifiedScopes, scopesInstalledOrRemoved);
+        }
+    }
+
     Q_EMIT metadataRefreshed();
 
     m_listThread = nullptr;
+    if (m_metadataRefreshPending) {
+        refreshScopeMetadata();
+    }
+}
+
+void Scopes::updateScopeMetadata(Scope::Ptr const& scope, QSet<QString> const& modifiedScopes, bool scopesInstalledOrRemoved)
+{
+    auto it = m_cachedMetadata.constFind(scope->id());
+    if (it == m_cachedMetadata.constEnd()) {
+        return;
+    }
+
+    if (modifiedScopes.contains(it.key())) {
+        scope->setScopeData(*(it.value()));
+    } else if (!scopesInstalledOrRemoved || !it.value()->is_aggregator()) {
+        // installing or removing a scope may only change child scopes of aggregators
+        return;
+    }
+
+    scope->invalidateChildScopes();
+    scope->invalidateResults(true);
+}
+
+qint64 Scopes::memoryUsage() const
+{
+    return m_memoryUsage;
+}
+
+qint64 Scopes::memoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+void Scopes::setMemoryBudget(qint64 bytes)
+{
+    bytes = std::max<qint64>(0, bytes);
+    if (bytes != m_memoryBudget) {
+        m_memoryBudget = bytes;
+        Q_EMIT memoryBudgetChanged();
+        scheduleMemoryBudgetCheck();
+    }
+}
+
+void Scopes::scheduleMemoryBudgetCheck()
+{
+    // coalesce checks of searches finishing at about the same time
+    if (!m_memoryBudgetTimer.isActive()) {
+        m_memoryBudgetTimer.start();
+    }
+}
+
+void Scopes::updateMemoryUsage()
+{
+    qint64 usage = 0;
+    Q_FOREACH(Scope::Ptr scope, m_scopes + m_tempScopes.values() + m_scopesToDelete) {
+        usage += scope->memoryUsage();
+    }
+    if (usage != m_memoryUsage) {
+        m_memoryUsage = usage;
+        Q_EMIT memoryUsageChanged();
+    }
+}
+
+void Scopes::enforceMemoryBudget()
+{
+    QList<QPair<Scope::Ptr, qint64>> candidates;
+    qint64 usage = 0;
+    Q_FOREACH(Scope::Ptr scope, m_scopes + m_tempScopes.values() + m_scopesToDelete) {
+        const qint64 scopeUsage = scope->memoryUsage();
+        usage += scopeUsage;
+        if (!scope->isActive() && scopeUsage > 0) {
+            candidates.append(qMakePair(scope, scopeUsage));
+        }
+    }
+
+    if (m_memoryBudget > 0 && usage > m_memoryBudget) {
+        qDebug() << "Results memory usage" << usage << "exceeds the budget of" << m_memoryBudget << "bytes";
+
+        // least recently viewed scopes first
+        std::sort(candidates.begin(), candidates.end(), [](QPair<Scope::Ptr, qint64> const& a, QPair<Scope::Ptr, qint64> const& b) {
+            return a.first->lastViewed() < b.first->lastViewed();
+        });
+
+        // hibernated scopes still keep their displayed search; drop it in the second pass if that's not enough
+        for (int pass = 0; pass < 2 && usage > m_memoryBudget; pass++) {
+            for (auto& candidate: candidates) {
+                if (usage <= m_memoryBudget) {
+                    break;
+                }
+                if (pass == 0) {
+                    candidate.first->hibernate();
+                } else {
+                    candidate.first->invalidateSearchCache();
+                }
+                const qint64 scopeUsage = candidate.first->memoryUsage();
+                usage -= candidate.second - scopeUsage;
+                candidate.second = scopeUsage;
+            }
+        }
+    }
+
+    if (usage != m_memoryUsage) {
+        m_memoryUsage = usage;
+        Q_EMIT memoryUsageChanged();
+    }
+}
+
+void Scopes::hibernateInactiveScopes()
+{
+    const qint64 usage = m_memoryUsage;
+    Q_FOREACH(Scope::Ptr scope, m_scopes + m_tempScopes.values() + m_scopesToDelete) {
+        scope->hibernate();
+    }
+    updateMemoryUsage();
+    qDebug() << "Hibernated inactive scopes, memory usage" << usage << "->" << m_memoryUsage << "bytes";
+}
+
+void Scopes::locationRequeryNeeded()
+{
+    Q_FOREACH(Scope::Ptr scope, m_scopes + m_tempScopes.values()) {
+        scope->refreshForLocation();
+    }
 }
 
 void Scopes::invalidateScopeResults(QString const& scopeName)
@@ -566,6 +860,7 @@ void Scopes::invalidateScopeResults(QString const& scopeName)
     }
 
     if (scope) {
+        scope->invalidateSearchCache();
         scope->invalidateResults();
     } else {
         qWarning() << "invalidateScopeResults: no such scope '" << scopeName << "'";
@@ -575,16 +870,8 @@ void Scopes::invalidateScopeResults(QString const& scopeName)
 void Scopes::scopeRegistryChanged()
 {
     qDebug() << "Refreshing scope metadata";
+    // scopes are invalidated in refreshFinished(), once we know which of them changed
     refreshScopeMetadata();
-    Q_FOREACH(Scope::Ptr scope, m_scopes) {
-        scope->invalidateChildScopes();
-        scope->invalidateResults(true);
-    }
-
-    Q_FOREACH(Scope::Ptr scope, m_tempScopes) {
-        scope->invalidateChildScopes();
-        scope->invalidateResults(true);
-    }
 }
 
 QVariant Scopes::data(const QModelIndex& index, int role) const
@@ -691,6 +978,7 @@ void Scopes::addTempScope(Scope::Ptr const& scope)
 void Scopes::closeScope(unity::shell::scopes::ScopeInterface* scope)
 {
     m_tempScopes.remove(scope->id());
+    scheduleMemoryBudgetCheck();
 }
 
 Scope::Ptr Scopes::findTempScope(QString const& id) const
@@ -731,10 +1019,14 @@ scopes::ScopeMetadata::SPtr Scopes::getCachedMetadata(QString const& scopeId) co
 
 void Scopes::refreshScopeMetadata()
 {
-    // make sure there's just one listing in-progress at any given time
-    if (m_listThread == nullptr && m_scopesRuntime) {
+    // make sure there's just one listing in-progress at any given time; if one is running, list again once it's done
+    if (m_listThread != nullptr) {
+        m_metadataRefreshPending = true;
+    } else if (m_scopesRuntime) {
+        m_metadataRefreshPending = false;
         auto thread = new ScopeListWorker;
         thread->setRuntime(m_scopesRuntime);
+        thread->setSnapshotPath(m_snapshotPath);
         QObject::connect(thread, &ScopeListWorker::discoveryFinished, this, &Scopes::refreshFinished);
         QObject::connect(thread, &ScopeListWorker::finished, thread, &QObject::deleteLater);
 
@@ -768,6 +1060,11 @@ UbuntuLocationService::Ptr Scopes::locationService() const
     return m_locationService;
 }
 
+QueryScheduler* Scopes::queryScheduler() const
+{
+    return m_queryScheduler;
+}
+
 } // namespace scopes_ng
 
 #include <scopes.moc>
@@ -27,6 +27,7 @@
 // Qt
 #include <QList>
 #include <QThread>
+#include <QElapsedTimer>
 #include <QTimer>
 #include <QStringList>
 #include <QSharedPointer>
@@ -49,10 +50,15 @@ class LocationAccessHelper;
 class Scope;
 class Favorites;
 class OverviewScope;
+class QueryScheduler;
 
 class Q_DECL_EXPORT Scopes : public unity::shell::scopes::ScopesInterface
 {
     Q_OBJECT
+
+    Q_PROPERTY(qint64 memoryUsage READ memoryUsage NOTIFY memoryUsageChanged)
+    Q_PROPERTY(qint64 memoryBudget READ memoryBudget WRITE setMemoryBudget NOTIFY memoryBudgetChanged)
+
 public:
     explicit Scopes(QObject *parent = 0);
     ~Scopes();
@@ -73,21 +79,37 @@ public:
 
     void refreshScopeMetadata();
 
+    // estimated memory used by results of all scopes, in bytes, as of the last budget check
+    qint64 memoryUsage() const;
+    // results of least recently viewed scopes are released when the usage exceeds the budget; 0 means unlimited
+    qint64 memoryBudget() const;
+    void setMemoryBudget(qint64 bytes);
+    void scheduleMemoryBudgetCheck();
+
     bool loaded() const override;
     int count() const override;
     unity::shell::scopes::ScopeInterface* overviewScope() const override;
     Scope::Ptr overviewScopeSPtr() const;
 
     QSharedPointer<UbuntuLocationService> locationService() const;
+    QueryScheduler* queryScheduler() const;
     QString userAgentString() const;
+    // searches of location-aware scopes are held back until the initial location is known (or the wait timed out)
+    bool waitingForInitialLocation() const;
 
     Scope::Ptr findTempScope(QString const& id) const;
     void addTempScope(Scope::Ptr const& scope);
     Q_INVOKABLE void closeScope(unity::shell::scopes::ScopeInterface* scope) override;
     QSharedPointer<LocationAccessHelper> locationAccessHelper() const;
 
+public Q_SLOTS:
+    // release results of all inactive scopes, e.g. when the system is low on memory
+    void hibernateInactiveScopes();
+
 Q_SIGNALS:
     void metadataRefreshed();
+    void memoryUsageChanged();
+    void memoryBudgetChanged();
 
 protected:
     virtual QString readPartnerId();
@@ -104,12 +126,29 @@ private Q_SLOTS:
 
     void initPopulateScopes();
     void lsbReleaseFinished();
+    void locationPhaseFinished();
     void completeDiscoveryFinished();
     void purgeScopesToDelete();
     void scopeRegistryChanged();
+    void locationRequeryNeeded();
+    void enforceMemoryBudget();
 
 private:
+    // independent startup steps; the scopes model is populated (and startup queries dispatched) once the
+    // user agent and the registry are known, only location-aware scopes also wait for the location phase
+    enum StartupPhase {
+        UserAgentPhase = 1,
+        RegistryPhase = 2,
+        LocationPhase = 4,
+        DiscoveryPhases = UserAgentPhase | RegistryPhase
+    };
+
     void createUserAgentString();
+    void populateScopesFromSnapshot();
+    void waitForInitialLocation();
+    void startupPhaseFinished(StartupPhase phase);
+    void updateMemoryUsage();
+    void updateScopeMetadata(Scope::Ptr const& scope, QSet<QString> const& modifiedScopes, bool scopesInstalledOrRemoved);
 
     static int LIST_DELAY;
     static const int SCOPE_DELETE_DELAY;
@@ -119,6 +158,7 @@ private:
     QList<QSharedPointer<Scope>> m_scopesToDelete;
     bool m_noFavorites;
     Favorites* m_favoriteScopes;
+    QueryScheduler* m_queryScheduler;
     QGSettings* m_dashSettings;
     QMap<QString, unity::scopes::ScopeMetadata::SPtr> m_cachedMetadata;
     QSharedPointer<OverviewScope> m_overviewScope;
@@ -127,11 +167,19 @@ private:
     QString m_userAgent;
     bool m_loaded;
     bool m_prepopulateFirstScope;
+    bool m_populatedFromSnapshot;
+    int m_finishedStartupPhases;
+    bool m_metadataRefreshPending;
+    qint64 m_memoryBudget;
+    qint64 m_memoryUsage;
+    QElapsedTimer m_startupTimer;
+    QString m_snapshotPath;
 
     QSharedPointer<UbuntuLocationService> m_locationService;
     QTimer m_startupQueryTimeout;
     QTimer m_scopesToDeleteTimer;
     QTimer m_registryRefreshTimer;
+    QTimer m_memoryBudgetTimer;
     QSharedPointer<LocationAccessHelper> m_locationAccessHelper;
 
     unity::scopes::Runtime::SPtr m_scopesRuntime;
@@ -147,6 +195,7 @@ class ScopeListWorker: public QThread
 public:
     void setRuntime(unity::scopes::Runtime::SPtr const& runtime);
     void setRuntimeConfig(QString const& config);
+    void setSnapshotPath(QString const& path);
     void run() override;
     unity::scopes::Runtime::SPtr getRuntime() const;
     unity::scopes::MetadataMap metadataMap() const;
@@ -156,6 +205,7 @@ Q_SIGNALS:
 
 private:
     QString m_runtimeConfig;
+    QString m_snapshotPath;
     unity::scopes::Runtime::SPtr m_scopesRuntime;
     unity::scopes::MetadataMap m_metadataMap;
 };
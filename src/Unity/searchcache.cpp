@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "searchcache.h"
+#include "utils.h"
+
+#include <algorithm>
+
+namespace scopes_ng
+{
+
+qint64 CachedSearch::estimateSize(QList<std::shared_ptr<unity::scopes::CategorisedResult>> const& results)
+{
+    qint64 size = 0;
+    for (auto const& result: results) {
+        size += estimateResultSize(*result);
+    }
+    return size;
+}
+
+SearchCache::SearchCache(int capacity)
+    : m_capacity(std::max(0, capacity)),
+      m_memoryUsage(0)
+{
+}
+
+int SearchCache::capacity() const
+{
+    return m_capacity;
+}
+
+int SearchCache::count() const
+{
+    return m_searches.size();
+}
+
+qint64 SearchCache::memoryUsage() const
+{
+    return m_memoryUsage;
+}
+
+bool SearchCache::contains(QString const& key) const
+{
+    return m_searches.contains(key);
+}
+
+QString SearchCache::locationKey(QString const& key, double latitude, double longitude)
+{
+    return key + QStringLiteral("@%1,%2").arg(latitude, 0, 'f', 2).arg(longitude, 0, 'f', 2);
+}
+
+void SearchCache::insert(QString const& key, CachedSearch const& search)
+{
+    if (m_capacity == 0) {
+        return;
+    }
+
+    auto it = m_searches.constFind(key);
+    if (it != m_searches.constEnd()) {
+        m_memoryUsage -= it.value().size;
+        m_keys.removeOne(key);
+    } else if (m_keys.size() >= m_capacity) {
+        m_memoryUsage -= m_searches.take(m_keys.takeFirst()).size;
+    }
+    m_keys.append(key);
+
+    CachedSearch entry(search);
+    if (entry.size == 0) {
+        entry.size = CachedSearch::estimateSize(search.results);
+    }
+    m_memoryUsage += entry.size;
+    m_searches.insert(key, entry);
+}
+
+bool SearchCache::lookup(QString const& key, CachedSearch& search)
+{
+    auto it = m_searches.constFind(key);
+    if (it == m_searches.constEnd()) {
+        return false;
+    }
+    search = it.value();
+
+    if (m_keys.last() != key) {
+        m_keys.removeOne(key);
+        m_keys.append(key);
+    }
+    return true;
+}
+
+void SearchCache::clear()
+{
+    m_keys.clear();
+    m_searches.clear();
+    m_memoryUsage = 0;
+}
+
+void SearchCache::trim(int maxCount)
+{
+    while (m_keys.size() > std::max(0, maxCount)) {
+        m_memoryUsage -= m_searches.take(m_keys.takeFirst()).size;
+    }
+}
+
+} // namespace scopes_ng
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NG_SEARCH_CACHE_H
+#define NG_SEARCH_CACHE_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <memory>
+
+#include <unity/scopes/CategorisedResult.h>
+#include <unity/scopes/Department.h>
+#include <unity/scopes/FilterBase.h>
+
+namespace scopes_ng
+{
+
+/**
+  Results of a finished search, together with departments and filters
+  received with them.
+*/
+struct CachedSearch
+{
+    QList<std::shared_ptr<unity::scopes::CategorisedResult>> results;
+    unity::scopes::Department::SCPtr rootDepartment;
+    QList<unity::scopes::FilterBase::SCPtr> filters;
+    QElapsedTimer timestamp; // started when the search finished
+    qint64 size = 0; // estimated memory used by the results, computed by SearchCache::insert() if not known
+
+    static qint64 estimateSize(QList<std::shared_ptr<unity::scopes::CategorisedResult>> const& results);
+};
+
+/**
+  LRU cache of finished searches of a single scope, keyed by the serialized canned query.
+*/
+class Q_DECL_EXPORT SearchCache
+{
+public:
+    explicit SearchCache(int capacity);
+
+    // Key for a search made from the given position; positions are rounded to roughly 1 km,
+    // so that small movements don't defeat the cache.
+    static QString locationKey(QString const& key, double latitude, double longitude);
+
+    int capacity() const;
+    int count() const;
+    qint64 memoryUsage() const;
+
+    bool contains(QString const& key) const;
+    void insert(QString const& key, CachedSearch const& search);
+    // looks up a search and marks it as most recently used; returns false if not cached
+    bool lookup(QString const& key, CachedSearch& search);
+    void clear();
+    // evicts least recently used searches until at most maxCount are left
+    void trim(int maxCount);
+
+private:
+    int m_capacity;
+    QList<QString> m_keys; // least recently used first
+    QHash<QString, CachedSearch> m_searches;
+    qint64 m_memoryUsage;
+};
+
+} // namespace scopes_ng
+
+#endif
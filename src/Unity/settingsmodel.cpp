@@ -26,10 +26,14 @@
 
 #include <QDebug>
 #include <QDir>
+#include <QFutureWatcher>
+#include <QTemporaryFile>
 #include <QTextCodec>
 #include <QTimer>
+#include <QtConcurrent>
 
 #include <fcntl.h>
+#include <stdio.h>
 #include <unistd.h>
 
 using namespace scopes_ng;
@@ -42,7 +46,7 @@ typedef unity::util::ResourcePtr<int, std::function<void(int)>> FileLock;
 
 static FileLock unixLock(const QString& path, bool writeLock)
 {
-    FileLock fileLock(::open(path.toUtf8(), writeLock ? O_WRONLY : O_RDONLY), [](int fd)
+    FileLock fileLock(::open(path.toUtf8(), O_RDWR | O_CREAT, 0644), [](int fd)
     {
         if (fd != -1)
         {
@@ -71,6 +75,12 @@ static FileLock unixLock(const QString& path, bool writeLock)
 
 static const char* GROUP_NAME = "General";
 
+struct ChildScopesReply
+{
+    bool ok = false;
+    sc::ChildScopeList child_scopes;
+};
+
 }  // namespace
 
 SettingsModel::SettingsModel(const QDir& configDir, const QString& scopeId,
@@ -78,12 +88,15 @@ SettingsModel::SettingsModel(const QDir& configDir, const QString& scopeId,
         QObject* parent,
         int settingsTimeout)
         : SettingsModelInterface(parent), m_scopeId(scopeId), m_settingsTimeout(settingsTimeout),
-          m_requireChildScopesRefresh(false)
+          m_valuesLoaded(false), m_requireChildScopesRefresh(false), m_childScopesRequest(0),
+          m_childScopesFetchInProgress(false), m_childScopesRefetch(false),
+          m_childScopesWriteInProgress(false), m_childScopesWritePending(false)
 {
     configDir.mkpath(scopeId);
     QDir databaseDir = configDir.filePath(scopeId);
 
     m_settings_path = databaseDir.filePath(QStringLiteral("settings.ini"));
+    m_settings_lock_path = databaseDir.filePath(QStringLiteral("settings.ini.lock"));
 
     try
     {
@@ -94,6 +107,22 @@ SettingsModel::SettingsModel(const QDir& configDir, const QString& scopeId,
         // No settings file found, at this point we'll just have to continue with a null m_settings.
     }
 
+    m_settingsTimer = new QTimer(this);
+    m_settingsTimer->setSingleShot(true);
+    m_settingsTimer->setInterval(m_settingsTimeout);
+    m_settingsTimer->setTimerType(Qt::VeryCoarseTimer);
+    connect(m_settingsTimer, SIGNAL(timeout()), this, SLOT(settings_timeout()));
+
+    // settings.ini may be rewritten (or replaced) by another process; the directory is watched too,
+    // as the file may not exist yet
+    m_settingsWatcher.addPath(databaseDir.path());
+    if (QFile::exists(m_settings_path))
+    {
+        m_settingsWatcher.addPath(m_settings_path);
+    }
+    connect(&m_settingsWatcher, &QFileSystemWatcher::fileChanged, this, &SettingsModel::settingsFileChanged);
+    connect(&m_settingsWatcher, &QFileSystemWatcher::directoryChanged, this, &SettingsModel::settingsFileChanged);
+
     for (const auto &it : settingsDefinitions.toList())
     {
         QVariantMap data = it.toMap();
@@ -138,15 +167,6 @@ SettingsModel::SettingsModel(const QDir& configDir, const QString& scopeId,
             properties[QStringLiteral("defaultValue")] = defaultValue;
         }
 
-        QSharedPointer<QTimer> timer(new QTimer());
-        timer->setProperty("setting_id", id);
-        timer->setSingleShot(true);
-        timer->setInterval(m_settingsTimeout);
-        timer->setTimerType(Qt::VeryCoarseTimer);
-        connect(timer.data(), SIGNAL(timeout()), this,
-                SLOT(settings_timeout()));
-        m_timers[id] = timer;
-
         QSharedPointer<Data> setting(
                 new Data(id, displayName, type, properties, defaultValue,
                         variantType));
@@ -181,38 +201,8 @@ QVariant SettingsModel::data(const QModelIndex& index, int role) const
                 break;
             case Roles::RoleValue:
             {
-                try
-                {
-                    tryLoadSettings(true);
-                    switch (data->variantType)
-                    {
-                        case QVariant::Bool:
-                            result = m_settings->get_boolean(GROUP_NAME, data->id.toStdString());
-                            break;
-                        case QVariant::UInt:
-                            result = m_settings->get_int(GROUP_NAME, data->id.toStdString());
-                            break;
-                        case QVariant::Double:
-                            result = m_settings->get_double(GROUP_NAME, data->id.toStdString());
-                            break;
-                        case QVariant::String:
-                            result = m_settings->get_string(GROUP_NAME, data->id.toStdString()).c_str();
-                            break;
-                        default:
-                            result = data->defaultValue;
-                    }
-                }
-                catch(const unity::FileException& e)
-                {
-                    qWarning() << "SettingsModel::data: Failed to read settings file:" << e.what();
-                    result = data->defaultValue;
-                }
-                catch(const unity::LogicException&)
-                {
-                    qWarning() << "SettingsModel::data: Failed to get a value for setting:" << data->id;
-                    result = data->defaultValue;
-                }
-                result.convert(data->variantType);
+                loadValues();
+                result = m_values.value(data->id);
                 break;
             }
             default:
@@ -267,41 +257,8 @@ QVariant SettingsModel::value(const QString& id) const
     }
     else if (m_data_by_id.contains(id))
     {
-        QSharedPointer<Data> data = m_data_by_id[id];
-        QVariant result;
-        try
-        {
-            tryLoadSettings(true);
-            switch (data->variantType)
-            {
-                case QVariant::Bool:
-                    result = m_settings->get_boolean(GROUP_NAME, data->id.toStdString());
-                    break;
-                case QVariant::UInt:
-                    result = m_settings->get_int(GROUP_NAME, data->id.toStdString());
-                    break;
-                case QVariant::Double:
-                    result = m_settings->get_double(GROUP_NAME, data->id.toStdString());
-                    break;
-                case QVariant::String:
-                    result = m_settings->get_string(GROUP_NAME, data->id.toStdString()).c_str();
-                    break;
-                default:
-                    result = data->defaultValue;
-            }
-        }
-        catch(const unity::FileException& e)
-        {
-            qWarning() << "SettingsModel::value: Failed to read settings file:" << e.what();
-            result = data->defaultValue;
-        }
-        catch(const unity::LogicException&)
-        {
-            qWarning() << "SettingsModel::value: Failed to get a value for setting:" << data->id;
-            result = data->defaultValue;
-        }
-        result.convert(data->variantType);
-        return result;
+        loadValues();
+        return m_values.value(id);
     }
 
     return QVariant();
@@ -316,31 +273,69 @@ void SettingsModel::update_child_scopes(QMap<QString, sc::ScopeMetadata::SPtr> c
     }
 
     m_scopeProxy = scopes_metadata[m_scopeId]->proxy();
-    try
+    m_childScopesMetadata = scopes_metadata;
+
+    if (m_childScopesWriteInProgress)
     {
-        m_child_scopes = m_scopeProxy->child_scopes();
+        // the reply could predate the list being written, ask again once the aggregator has it
+        m_childScopesRefetch = true;
+        return;
     }
-    catch (std::exception const& e)
+
+    // child_scopes() is a round trip to the aggregator, don't block the UI (and the search being dispatched) on it
+    const int request = ++m_childScopesRequest;
+    m_childScopesFetchInProgress = true;
+    sc::ScopeProxy proxy = m_scopeProxy;
+    auto watcher = new QFutureWatcher<ChildScopesReply>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, request, scopes_metadata]() {
+        const ChildScopesReply reply = watcher->result();
+        watcher->deleteLater();
+        child_scopes_fetched(request, reply.ok, reply.child_scopes, scopes_metadata);
+    });
+    watcher->setFuture(QtConcurrent::run([proxy]() {
+        ChildScopesReply reply;
+        try
+        {
+            reply.child_scopes = proxy->child_scopes();
+            reply.ok = true;
+        }
+        catch (std::exception const& e)
+        {
+            qWarning("SettingsModel::update_child_scopes: Exception caught from m_scopeProxy->child_scopes(): %s", e.what());
+        }
+        return reply;
+    }));
+}
+
+void SettingsModel::child_scopes_fetched(int request, bool ok, sc::ChildScopeList const& child_scopes,
+        QMap<QString, sc::ScopeMetadata::SPtr> const& scopes_metadata)
+{
+    if (request != m_childScopesRequest)
     {
-        qWarning("SettingsModel::update_child_scopes: Exception caught from m_scopeProxy->child_scopes_ordered(): %s", e.what());
+        // superseded by a newer request or by a set_child_scopes() call
         return;
     }
+    m_childScopesFetchInProgress = false;
 
-    const bool reset = m_requireChildScopesRefresh;
-    if (reset) {
-        // Reset the settings model to fix LP: #1484299, where a new child scope just finished installing
-        // while settings view is created (and we crash); since this is really a corner case, just
-        // resetting the model is fine.
-        beginResetModel();
+    if (!ok)
+    {
+        return;
     }
 
-    m_requireChildScopesRefresh = false;
-
-    m_child_scopes_data.clear();
-    m_child_scopes_data_by_id.clear();
-    m_child_scopes_timers.clear();
+    sc::ChildScopeList new_child_scopes = child_scopes;
+    // changes the user made in the meantime haven't been sent to the aggregator yet
+    for (auto& child_scope : new_child_scopes)
+    {
+        auto it = m_pendingChildScopes.constFind(QString::fromStdString(child_scope.id));
+        if (it != m_pendingChildScopes.constEnd())
+        {
+            child_scope.enabled = it.value();
+        }
+    }
 
-    for (sc::ChildScope const& child_scope : m_child_scopes)
+    m_requireChildScopesRefresh = false;
+    QList<QSharedPointer<Data>> new_child_scopes_data;
+    for (sc::ChildScope const& child_scope : new_child_scopes)
     {
         QString id = child_scope.id.c_str();
         if (!scopes_metadata.contains(id)) {
@@ -352,18 +347,62 @@ void SettingsModel::update_child_scopes(QMap<QString, sc::ScopeMetadata::SPtr> c
         }
         QString displayName = QString::fromStdString(_("Display results from %1")).arg(QString(scopes_metadata[id]->display_name().c_str()));
 
-        QSharedPointer<Data> setting(
+        new_child_scopes_data << QSharedPointer<Data>(
                 new Data(id, displayName, QStringLiteral("boolean"), QVariantMap(), QVariant(), QVariant::Bool));
+    }
+
+    // the reply usually matches what the model shows already (it's requested on every search), so only
+    // reset the model, and lose the state of the settings view, when the rows themselves changed
+    bool sameRows = new_child_scopes.size() == m_child_scopes.size()
+        && new_child_scopes_data.size() == m_child_scopes_data.size();
+    for (int i = 0; sameRows && i < new_child_scopes_data.size(); i++)
+    {
+        sameRows = new_child_scopes_data[i]->id == m_child_scopes_data[i]->id
+            && new_child_scopes_data[i]->displayName == m_child_scopes_data[i]->displayName;
+    }
+    for (auto it = new_child_scopes.cbegin(), old = m_child_scopes.cbegin(); sameRows && it != new_child_scopes.cend(); ++it, ++old)
+    {
+        sameRows = it->id == old->id;
+    }
+
+    if (sameRows)
+    {
+        QList<int> changedRows;
+        int row = m_data.size();
+        for (auto it = new_child_scopes.cbegin(), old = m_child_scopes.cbegin(); it != new_child_scopes.cend(); ++it, ++old, ++row)
+        {
+            if (it->enabled != old->enabled)
+            {
+                changedRows << row;
+            }
+        }
 
-        m_child_scopes_data << setting;
-        m_child_scopes_data_by_id[id] = setting;
+        m_child_scopes = new_child_scopes;
+        for (int changedRow : changedRows)
+        {
+            Q_EMIT dataChanged(index(changedRow), index(changedRow), {Roles::RoleValue});
+        }
     }
+    else
+    {
+        // This also covers LP: #1484299, where a new child scope just finished installing while
+        // settings view is created.
+        beginResetModel();
+
+        m_child_scopes = new_child_scopes;
+        m_child_scopes_data = new_child_scopes_data;
+        m_child_scopes_data_by_id.clear();
+        for (auto const& setting : m_child_scopes_data)
+        {
+            m_child_scopes_data_by_id[setting->id] = setting;
+        }
 
-    if (reset) {
         endResetModel();
+
+        Q_EMIT countChanged();
     }
 
-    Q_EMIT countChanged();
+    Q_EMIT childScopesUpdated();
 }
 
 bool SettingsModel::setData(const QModelIndex &index, const QVariant &value,
@@ -379,9 +418,8 @@ bool SettingsModel::setData(const QModelIndex &index, const QVariant &value,
         {
             case Roles::RoleValue:
             {
-                QSharedPointer<QTimer> timer = m_timers[data->id];
-                timer->setProperty("value", value);
-                timer->start();
+                m_pendingValues[data->id] = value;
+                m_settingsTimer->start();
 
                 return true;
             }
@@ -397,22 +435,8 @@ bool SettingsModel::setData(const QModelIndex &index, const QVariant &value,
         {
             case Roles::RoleValue:
             {
-                if (!m_child_scopes_timers.contains(data->id))
-                {
-                    QSharedPointer<QTimer> timer(new QTimer());
-                    timer->setProperty("setting_id", data->id);
-                    timer->setSingleShot(true);
-                    timer->setInterval(m_settingsTimeout);
-                    timer->setTimerType(Qt::VeryCoarseTimer);
-                    connect(timer.data(), SIGNAL(timeout()), this,
-                            SLOT(settings_timeout()));
-                    m_child_scopes_timers[data->id] = timer;
-                }
-
-                QSharedPointer<QTimer> timer = m_child_scopes_timers[data->id];
-                timer->setProperty("index", row - m_data.size());
-                timer->setProperty("value", value);
-                timer->start();
+                m_pendingChildScopes[data->id] = value.toBool();
+                m_settingsTimer->start();
 
                 return true;
             }
@@ -441,79 +465,278 @@ bool SettingsModel::require_child_scopes_refresh() const
 
 void SettingsModel::settings_timeout()
 {
-    QObject *timer = sender();
-    if (!timer)
+    QMap<QString, bool> childScopes;
+    childScopes.swap(m_pendingChildScopes);
+    QMap<QString, QVariant> values;
+    values.swap(m_pendingValues);
+
+    bool childScopesChanged = false;
+    for (auto it = childScopes.constBegin(); it != childScopes.constEnd(); ++it)
     {
-        return;
+        for (auto& child_scope : m_child_scopes)
+        {
+            if (child_scope.id == it.key().toStdString())
+            {
+                child_scope.enabled = it.value();
+                childScopesChanged = true;
+            }
+        }
     }
 
-    QString setting_id = timer->property("setting_id").toString();
-    QVariant value = timer->property("value");
-
     // Check for the setting id in the child scopes list first, in case the
     // aggregator is incorrectly using a scope id as a settings as well.
-    if (m_child_scopes_data_by_id.contains(setting_id))
+    for (auto it = values.begin(); it != values.end(); )
     {
-        int setting_index = timer->property("index").toInt();
-        auto it = std::next(m_child_scopes.begin(), setting_index);
-        it->enabled = value.toBool();
-
-        if (m_scopeProxy)
+        if (m_child_scopes_data_by_id.contains(it.key()) || !m_data_by_id.contains(it.key()))
         {
-            try
-            {
-                m_scopeProxy->set_child_scopes(m_child_scopes);
-
-                Q_EMIT settingsChanged();
-            }
-            catch (std::exception const& e)
-            {
-                qWarning("SettingsModel::settings_timeout: Exception caught from m_scopeProxy->set_child_scopes(): %s", e.what());
-                return;
-            }
+            qWarning() << "No such setting:" << it.key();
+            it = values.erase(it);
+        }
+        else
+        {
+            ++it;
         }
     }
-    else if (m_data_by_id.contains(setting_id))
+
+    bool settingsWritten = false;
+    if (!values.empty())
     {
         try
         {
-            tryLoadSettings(false);
+            writeSettings(values);
+            settingsWritten = true;
+        }
+        catch(const unity::FileException& e)
+        {
+            qWarning() << "SettingsModel::settings_timeout: Failed to write settings file:" << e.what();
+        }
+        catch(const unity::LogicException& e)
+        {
+            qWarning() << "SettingsModel::settings_timeout: Failed to set setting values:" << e.what();
+        }
+    }
+
+    if (childScopesChanged && m_scopeProxy)
+    {
+        // settingsChanged() is emitted once the aggregator accepted the new list
+        store_child_scopes();
+    }
+    else if (settingsWritten)
+    {
+        Q_EMIT settingsChanged();
+    }
+}
+
+void SettingsModel::writeSettings(QMap<QString, QVariant> const& values)
+{
+    // All values are written to a copy of the current file which then replaces it, so that readers
+    // (in this or in the scope process) never see a partially written file.
+    FileLock lock = unixLock(m_settings_lock_path, true);
+
+    if (!QFile::exists(m_settings_path) && !QFile(m_settings_path).open(QFile::WriteOnly))
+    {
+        throw unity::FileException("Could not create an empty settings file at: " + m_settings_path.toStdString(), -1);
+    }
+
+    QTemporaryFile temp(m_settings_path + QStringLiteral(".XXXXXX"));
+    QFile current(m_settings_path);
+    if (!temp.open() || !current.open(QFile::ReadOnly) || temp.write(current.readAll()) < 0 || !temp.flush())
+    {
+        throw unity::FileException("Could not create a temporary settings file for: " + m_settings_path.toStdString(), errno);
+    }
+    temp.setPermissions(current.permissions());
+    temp.close();
+
+    {
+        unity::util::IniParser parser(temp.fileName().toUtf8());
+        for (auto it = values.constBegin(); it != values.constEnd(); ++it)
+        {
+            const std::string id = it.key().toStdString();
+            QVariant const& value = it.value();
             switch (value.type())
             {
                 case QVariant::Bool:
-                    m_settings->set_boolean(GROUP_NAME, setting_id.toStdString(), value.toBool());
+                    parser.set_boolean(GROUP_NAME, id, value.toBool());
                     break;
                 case QVariant::Int:
                 case QVariant::UInt:
-                    m_settings->set_int(GROUP_NAME, setting_id.toStdString(), value.toUInt());
+                    parser.set_int(GROUP_NAME, id, value.toUInt());
                     break;
                 case QVariant::Double:
-                    m_settings->set_double(GROUP_NAME, setting_id.toStdString(), value.toDouble());
+                    parser.set_double(GROUP_NAME, id, value.toDouble());
                     break;
                 case QVariant::String:
-                    m_settings->set_string(GROUP_NAME, setting_id.toStdString(), value.toString().toStdString());
+                    parser.set_string(GROUP_NAME, id, value.toString().toStdString());
                     break;
                 default:
-                    qWarning() << "SettingsModel::settings_timeout: Invalid value type for setting:" << setting_id;
+                    qWarning() << "SettingsModel::writeSettings: Invalid value type for setting:" << it.key();
             }
-            FileLock lock = unixLock(m_settings_path, true);
-            m_settings->sync(); // make sure the change to setting value is synced to fs
+        }
+        parser.sync();
+    }
+
+    if (::rename(temp.fileName().toUtf8(), m_settings_path.toUtf8()) != 0)
+    {
+        throw unity::FileException("Could not replace settings file: " + m_settings_path.toStdString(), errno);
+    }
+    temp.setAutoRemove(false);
+
+    // the parser of the old file is stale now; values of the settings we wrote are known already
+    m_settings.reset();
+    if (m_valuesLoaded)
+    {
+        for (auto it = values.constBegin(); it != values.constEnd(); ++it)
+        {
+            QVariant stored(it.value());
+            stored.convert(m_data_by_id[it.key()]->variantType);
+            m_values[it.key()] = stored;
+        }
+    }
+}
 
+void SettingsModel::store_child_scopes()
+{
+    // only one set_child_scopes() call at a time, so that the aggregator can't receive them out of order;
+    // changes made in the meantime are sent together once it finishes
+    if (m_childScopesWriteInProgress)
+    {
+        m_childScopesWritePending = true;
+        return;
+    }
+    m_childScopesWriteInProgress = true;
+    m_childScopesWritePending = false;
+
+    // a child_scopes() reply that is still on its way may not reflect this write; drop it and ask again afterwards
+    ++m_childScopesRequest;
+    if (m_childScopesFetchInProgress)
+    {
+        m_childScopesFetchInProgress = false;
+        m_childScopesRefetch = true;
+    }
+
+    sc::ScopeProxy proxy = m_scopeProxy;
+    sc::ChildScopeList child_scopes = m_child_scopes;
+    auto watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        const bool ok = watcher->result();
+        watcher->deleteLater();
+        m_childScopesWriteInProgress = false;
+
+        if (m_childScopesWritePending)
+        {
+            store_child_scopes();
+            return;
+        }
+        if (ok)
+        {
             Q_EMIT settingsChanged();
         }
-        catch(const unity::FileException& e)
+        if (m_childScopesRefetch)
         {
-            qWarning() << "SettingsModel::settings_timeout: Failed to write settings file:" << e.what();
+            m_childScopesRefetch = false;
+            update_child_scopes(m_childScopesMetadata);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([proxy, child_scopes]() {
+        try
+        {
+            proxy->set_child_scopes(child_scopes);
+            return true;
         }
-        catch(const unity::LogicException&)
+        catch (std::exception const& e)
         {
-            qWarning() << "SettingsModel::settings_timeout: Failed to set a value for setting:" << setting_id;
+            qWarning("SettingsModel::store_child_scopes: Exception caught from m_scopeProxy->set_child_scopes(): %s", e.what());
         }
+        return false;
+    }));
+}
+
+void SettingsModel::loadValues() const
+{
+    if (m_valuesLoaded)
+    {
+        return;
     }
-    else
+    m_valuesLoaded = true;
+    m_values.clear();
+
+    try
+    {
+        tryLoadSettings(true);
+    }
+    catch(const unity::FileException& e)
+    {
+        qWarning() << "SettingsModel::loadValues: Failed to read settings file:" << e.what();
+    }
+
+    for (auto const& data : m_data)
+    {
+        QVariant result = data->defaultValue;
+        if (m_settings)
+        {
+            try
+            {
+                switch (data->variantType)
+                {
+                    case QVariant::Bool:
+                        result = m_settings->get_boolean(GROUP_NAME, data->id.toStdString());
+                        break;
+                    case QVariant::UInt:
+                        result = m_settings->get_int(GROUP_NAME, data->id.toStdString());
+                        break;
+                    case QVariant::Double:
+                        result = m_settings->get_double(GROUP_NAME, data->id.toStdString());
+                        break;
+                    case QVariant::String:
+                        result = m_settings->get_string(GROUP_NAME, data->id.toStdString()).c_str();
+                        break;
+                    default:
+                        break;
+                }
+            }
+            catch(const unity::LogicException&)
+            {
+                qWarning() << "SettingsModel::loadValues: Failed to get a value for setting:" << data->id;
+                result = data->defaultValue;
+            }
+        }
+        result.convert(data->variantType);
+        m_values[data->id] = result;
+    }
+}
+
+void SettingsModel::settingsFileChanged()
+{
+    // the file is replaced rather than rewritten by some writers, which drops it from the watcher
+    if (!m_settingsWatcher.files().contains(m_settings_path) && QFile::exists(m_settings_path))
+    {
+        m_settingsWatcher.addPath(m_settings_path);
+    }
+
+    m_settings.reset();
+    if (!m_valuesLoaded)
+    {
+        return;
+    }
+
+    const QMap<QString, QVariant> oldValues = m_values;
+    m_valuesLoaded = false;
+    loadValues();
+    if (m_values == oldValues)
     {
-        qWarning() << "No such setting:" << setting_id;
+        // e.g. our own write
+        return;
+    }
+
+    for (int row = 0; row < m_data.size(); row++)
+    {
+        const QString& id = m_data[row]->id;
+        if (m_values.value(id) != oldValues.value(id))
+        {
+            Q_EMIT dataChanged(index(row), index(row), {Roles::RoleValue});
+        }
     }
+    Q_EMIT settingsChanged();
 }
 
 void SettingsModel::tryLoadSettings(bool read_only) const
@@ -534,7 +757,7 @@ void SettingsModel::tryLoadSettings(bool read_only) const
             }
         }
 
-        FileLock lock = unixLock(m_settings_path, false);
+        FileLock lock = unixLock(m_settings_lock_path, false);
         m_settings.reset(new unity::util::IniParser(m_settings_path.toUtf8()));
     }
 }
@@ -28,6 +28,7 @@
 #include <unity/util/IniParser.h>
 
 #include <QAbstractListModel>
+#include <QFileSystemWatcher>
 #include <QList>
 #include <QSharedPointer>
 
@@ -80,18 +81,29 @@ public:
 
     QVariant value(const QString& id) const;
 
+    // Queries the child scopes of an aggregator in the background; the model is updated
+    // (and childScopesUpdated() emitted) once the reply arrives.
     void update_child_scopes(QMap<QString, unity::scopes::ScopeMetadata::SPtr> const& scopes_metadata);
 
     bool require_child_scopes_refresh() const;
 
 Q_SIGNALS:
     void settingsChanged();
+    void childScopesUpdated();
 
 protected Q_SLOTS:
     void settings_timeout();
 
+private Q_SLOTS:
+    void settingsFileChanged();
+
 private:
     void tryLoadSettings(bool read_only) const;
+    void loadValues() const;
+    void writeSettings(QMap<QString, QVariant> const& values);
+    void child_scopes_fetched(int request, bool ok, unity::scopes::ChildScopeList const& child_scopes,
+            QMap<QString, unity::scopes::ScopeMetadata::SPtr> const& scopes_metadata);
+    void store_child_scopes();
 
 protected:
     QString m_scopeId;
@@ -99,16 +111,31 @@ protected:
     int m_settingsTimeout;
 
     QString m_settings_path;
+    // settings.ini gets replaced on write, so readers and writers lock a separate file that stays put
+    QString m_settings_lock_path;
     QList<QSharedPointer<Data>> m_data;
     QMap<QString, QSharedPointer<Data>> m_data_by_id;
     mutable QScopedPointer<unity::util::IniParser> m_settings;
-    QMap<QString, QSharedPointer<QTimer>> m_timers;
+    // values of all settings, read once and refreshed when the settings file changes
+    mutable QMap<QString, QVariant> m_values;
+    mutable bool m_valuesLoaded;
+    QFileSystemWatcher m_settingsWatcher;
+    // setting changes waiting to be written together when m_settingsTimer fires
+    QTimer* m_settingsTimer;
+    QMap<QString, QVariant> m_pendingValues;
+    QMap<QString, bool> m_pendingChildScopes;
 
     QList<QSharedPointer<Data>> m_child_scopes_data;
     QMap<QString, QSharedPointer<Data>> m_child_scopes_data_by_id;
     unity::scopes::ChildScopeList m_child_scopes;
-    QMap<QString, QSharedPointer<QTimer>> m_child_scopes_timers;
     bool m_requireChildScopesRefresh;
+    int m_childScopesRequest;
+    // metadata of the last update_child_scopes() call, used to query the child scopes again after a write
+    QMap<QString, unity::scopes::ScopeMetadata::SPtr> m_childScopesMetadata;
+    bool m_childScopesFetchInProgress;
+    bool m_childScopesRefetch;
+    bool m_childScopesWriteInProgress;
+    bool m_childScopesWritePending;
 };
 
 }
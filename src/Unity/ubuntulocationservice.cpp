@@ -21,6 +21,8 @@
 
 #include <QDebug>
 
+#include <algorithm>
+
 using namespace std;
 using namespace scopes_ng;
 
@@ -38,6 +40,39 @@ namespace
      * Re-do the GeoIP call every 60 seconds
      */
     static const int GEOIP_INTERVAL = 60000;
+
+    /**
+     * The interval is doubled each time the lookup returns the same result, up to 30 minutes
+     */
+    static const int GEOIP_MAX_INTERVAL = 1800000;
+
+    /**
+     * Cached GeoIP results older than a day are not used
+     */
+    static const qint64 GEOIP_CACHE_TTL = 86400;
+
+    /**
+     * Minimum interval between position updates, shared by all scopes using the location
+     */
+    static const int LOCATION_UPDATE_INTERVAL = 30000;
+
+    /**
+     * Location-aware scopes re-run their searches when the location moves by more than 1 km,
+     * or by more than 200 m after 10 minutes
+     */
+    static const double REQUERY_DISTANCE = 1000.0;
+    static const double REQUERY_NOISE_DISTANCE = 200.0;
+    static const qint64 REQUERY_INTERVAL = 600000;
+
+    /**
+     * Location changes are coalesced into one requery within this period
+     */
+    static const int REQUERY_COALESCE_INTERVAL = 2000;
+
+    double envOverride(const char* name, double defaultValue)
+    {
+        return qEnvironmentVariableIsSet(name) ? QString::fromUtf8(qgetenv(name)).toDouble() : defaultValue;
+    }
 }
 
 class UbuntuLocationService::TokenImpl: public UbuntuLocationService::Token
@@ -61,7 +96,12 @@ Q_SIGNALS:
 };
 
 UbuntuLocationService::UbuntuLocationService(const GeoIp::Ptr& geoIp)
-    : m_geoIp(geoIp)
+    : m_active(false),
+      m_locationSource(nullptr),
+      m_requeryPolicy(envOverride("UNITY_SCOPES_LOCATION_REQUERY_DISTANCE", REQUERY_DISTANCE),
+            REQUERY_NOISE_DISTANCE,
+            envOverride("UNITY_SCOPES_LOCATION_REQUERY_INTERVAL", REQUERY_INTERVAL)),
+      m_geoIp(geoIp), m_geoIpInterval(GEOIP_INTERVAL)
 {
     // If the location service is disabled
     if (qEnvironmentVariableIsSet("UNITY_SCOPES_NO_LOCATION"))
@@ -69,14 +109,35 @@ UbuntuLocationService::UbuntuLocationService(const GeoIp::Ptr& geoIp)
         return;
     }
 
+    // Serve the result of the last lookup until a new one arrives
+    m_geoIpCachePath = GeoIp::defaultCachePath();
+    GeoIp::Result cached;
+    QDateTime timestamp;
+    if (GeoIp::loadCache(m_geoIpCachePath, cached, timestamp)
+            && timestamp.secsTo(QDateTime::currentDateTimeUtc()) < GEOIP_CACHE_TTL)
+    {
+        qDebug() << "Using cached GeoIP result from" << timestamp;
+        m_result = cached;
+        m_resultTimestamp = timestamp;
+        m_requeryPolicy.setReference(QGeoCoordinate(cached.latitude, cached.longitude), QDateTime::currentMSecsSinceEpoch());
+    }
+
     m_deactivateTimer.setInterval(DEACTIVATE_INTERVAL);
     m_deactivateTimer.setSingleShot(true);
     m_deactivateTimer.setTimerType(Qt::VeryCoarseTimer);
 
-    m_geoipTimer.setInterval(GEOIP_INTERVAL);
+    m_geoipTimer.setInterval(m_geoIpInterval);
     m_geoipTimer.setTimerType(Qt::CoarseTimer);
 
+    m_requeryTimer.setInterval(REQUERY_COALESCE_INTERVAL);
+    m_requeryTimer.setSingleShot(true);
+    connect(&m_requeryTimer, &QTimer::timeout, this, &UbuntuLocationService::requeryNeeded);
+
     m_locationSource = QGeoPositionInfoSource::createDefaultSource(this);
+    if (m_locationSource)
+    {
+        m_locationSource->setUpdateInterval(std::max(m_locationSource->minimumUpdateInterval(), LOCATION_UPDATE_INTERVAL));
+    }
     connect(m_locationSource, &QGeoPositionInfoSource::positionUpdated, this, &UbuntuLocationService::positionChanged);
     connect(m_locationSource, &QGeoPositionInfoSource::updateTimeout, this, &UbuntuLocationService::onPositionUpdateTimeout);
     connect(m_locationSource, SIGNAL(error(QGeoPositionInfoSource::Error)), this, SLOT(onError(QGeoPositionInfoSource::Error)));
@@ -94,6 +155,7 @@ UbuntuLocationService::UbuntuLocationService(const GeoIp::Ptr& geoIp)
     connect(this, &UbuntuLocationService::enqueueActivate, this, &UbuntuLocationService::doActivate, Qt::QueuedConnection);
     connect(this, &UbuntuLocationService::enqueueDeactivate, this, &UbuntuLocationService::doDeactivate, Qt::QueuedConnection);
 
+    // The cached result is refreshed in the background
     m_geoIp->start();
 }
 
@@ -120,8 +182,12 @@ void UbuntuLocationService::update()
 {
     if (m_activationCount > 0)
     {
-        // Update the GeoIp data again
-        m_geoIp->start();
+        // Update the GeoIp data again, unless the last result is recent enough
+        if (!m_resultTimestamp.isValid()
+                || m_resultTimestamp.msecsTo(QDateTime::currentDateTimeUtc()) >= m_geoIpInterval)
+        {
+            m_geoIp->start();
+        }
     }
 
     try
@@ -129,14 +195,20 @@ void UbuntuLocationService::update()
         if (m_activationCount > 0)
         {
             qDebug() << "Enabling location updates";
-            m_locationSource->startUpdates();
+            if (m_locationSource)
+            {
+                m_locationSource->startUpdates();
+            }
             m_geoipTimer.start();
         }
         else
         {
             qDebug() << "Disabling location updates";
             m_active = false;
-            m_locationSource->stopUpdates();
+            if (m_locationSource)
+            {
+                m_locationSource->stopUpdates();
+            }
             m_geoipTimer.stop();
         }
     }
@@ -151,6 +223,17 @@ void UbuntuLocationService::positionChanged(const QGeoPositionInfo& update)
     m_locationUpdatedAtLeastOnce = true;
     m_lastLocation = update;
     Q_EMIT locationChanged();
+
+    considerRequery(update.coordinate());
+}
+
+void UbuntuLocationService::considerRequery(const QGeoCoordinate& position)
+{
+    if (m_requeryPolicy.update(position, QDateTime::currentMSecsSinceEpoch()) && !m_requeryTimer.isActive())
+    {
+        qDebug() << "Location changed significantly, requery scheduled";
+        m_requeryTimer.start();
+    }
 }
 
 void UbuntuLocationService::onPositionUpdateTimeout()
@@ -171,8 +254,36 @@ void UbuntuLocationService::onError(QGeoPositionInfoSource::Error positioningErr
 void UbuntuLocationService::requestFinished(const GeoIp::Result& result)
 {
     qDebug() << "GeoIP request finished";
+    if (result.valid)
     {
+        // back off while the result doesn't change
+        if (m_result.valid && m_result == result)
+        {
+            m_geoIpInterval = std::min(m_geoIpInterval * 2, GEOIP_MAX_INTERVAL);
+        }
+        else
+        {
+            m_geoIpInterval = GEOIP_INTERVAL;
+        }
+
         m_result = result;
+        m_resultTimestamp = QDateTime::currentDateTimeUtc();
+        GeoIp::saveCache(m_geoIpCachePath, m_result, m_resultTimestamp);
+
+        // without a position fix searches use the GeoIP location
+        if (!(isActive() && m_locationUpdatedAtLeastOnce))
+        {
+            considerRequery(QGeoCoordinate(result.latitude, result.longitude));
+        }
+    }
+    else
+    {
+        // keep the last known result, but try again soon
+        m_geoIpInterval = GEOIP_INTERVAL;
+    }
+    if (m_geoipTimer.interval() != m_geoIpInterval)
+    {
+        m_geoipTimer.setInterval(m_geoIpInterval);
     }
     Q_EMIT geoIpLookupFinished();
 }
@@ -241,6 +352,11 @@ bool UbuntuLocationService::hasLocation() const
     return m_lastLocation.isValid() || m_locationUpdatedAtLeastOnce;
 }
 
+bool UbuntuLocationService::hasGeoIpLocation() const
+{
+    return m_result.valid;
+}
+
 QSharedPointer<UbuntuLocationService::Token> UbuntuLocationService::activate()
 {
     return QSharedPointer<Token>(new TokenImpl(*this));
@@ -249,7 +365,10 @@ QSharedPointer<UbuntuLocationService::Token> UbuntuLocationService::activate()
 void UbuntuLocationService::requestInitialLocation()
 {
     qDebug() << "Requesting initial location update";
-    m_locationSource->requestUpdate();
+    if (m_locationSource)
+    {
+        m_locationSource->requestUpdate();
+    }
     m_geoipTimer.start();
 }
 
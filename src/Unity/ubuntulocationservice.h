@@ -22,6 +22,7 @@
 #define UBUNTULOCATIONSERVICE_H
 
 #include "geoip.h"
+#include "locationrequerypolicy.h"
 
 #include <QObject>
 #include <QSharedPointer>
@@ -50,6 +51,8 @@ public:
     UbuntuLocationService(const GeoIp::Ptr& geoIp = GeoIp::Ptr(new GeoIp));
     unity::scopes::Location location() const;
     bool hasLocation() const;
+    // a GeoIP result is available, possibly restored from the cache of a previous session
+    bool hasGeoIpLocation() const;
     bool isActive() const;
     QSharedPointer<Token> activate();
 
@@ -65,6 +68,10 @@ Q_SIGNALS:
     // emited when geoip lookup finishes (including initial lookup on startup). regardless of apparmor permissions
     // (receiving it doesn't mean position updates are allowed).
     void geoIpLookupFinished();
+
+    // emited (at most once per coalescing period) when the location moved enough for location-aware
+    // scopes to re-run their searches
+    void requeryNeeded();
     void activeChanged();
     void accessDenied();
     void enqueueActivate();
@@ -80,6 +87,8 @@ protected Q_SLOTS:
     void requestFinished(const GeoIp::Result& result);
 
 protected:
+    void considerRequery(const QGeoCoordinate& position);
+
     bool m_active;
     QGeoPositionInfoSource *m_locationSource;
     QGeoPositionInfo m_lastLocation;
@@ -87,8 +96,13 @@ protected:
     int m_activationCount = 0;
     QTimer m_geoipTimer;
     QTimer m_deactivateTimer;
+    QTimer m_requeryTimer;
+    LocationRequeryPolicy m_requeryPolicy;
     GeoIp::Ptr m_geoIp;
     GeoIp::Result m_result;
+    QDateTime m_resultTimestamp;
+    QString m_geoIpCachePath;
+    int m_geoIpInterval;
 };
 
 } // namespace scopes_ng
@@ -20,13 +20,45 @@
 // self
 #include "utils.h"
 
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QStringList>
 
+#include <unity/scopes/CategorisedResult.h>
+
 namespace scopes_ng
 {
 
 using namespace unity;
 
+namespace
+{
+
+QString toQString(std::string const& str)
+{
+    return QString::fromUtf8(str.data(), static_cast<int>(str.size()));
+}
+
+std::string toStdString(QString const& str)
+{
+    // Most strings (keys, ids, uris) are plain ASCII; encode those straight into
+    // a pre-sized std::string instead of going through an intermediate QByteArray.
+    const int size = str.size();
+    const QChar* data = str.constData();
+    std::string result(static_cast<size_t>(size), '\0');
+    for (int i = 0; i < size; i++) {
+        const ushort c = data[i].unicode();
+        if (c >= 0x80) {
+            return str.toStdString();
+        }
+        result[i] = static_cast<char>(c);
+    }
+    return result;
+}
+
+}
+
 QVariant scopeVariantToQVariant(scopes::Variant const& variant)
 {
     switch (variant.which()) {
@@ -37,23 +69,25 @@ QVariant scopeVariantToQVariant(scopes::Variant const& variant)
         case scopes::Variant::Type::Bool:
             return QVariant(variant.get_bool());
         case scopes::Variant::Type::String:
-            return QVariant(QString::fromStdString(variant.get_string()));
+            return QVariant(toQString(variant.get_string()));
         case scopes::Variant::Type::Double:
             return QVariant(variant.get_double());
         case scopes::Variant::Type::Dict: {
-            scopes::VariantMap dict(variant.get_dict());
+            // get_dict() and get_array() hand out a copy; bind it instead of copying it again
+            auto const& dict = variant.get_dict();
             QVariantMap result_dict;
-            for (auto it = dict.begin(); it != dict.end(); ++it) {
-                result_dict.insert(QString::fromStdString(it->first), scopeVariantToQVariant(it->second));
+            for (auto const& kv: dict) {
+                // keys arrive sorted, so appending with an end() hint avoids a lookup per key
+                result_dict.insert(result_dict.constEnd(), toQString(kv.first), scopeVariantToQVariant(kv.second));
             }
             return result_dict;
         }
         case scopes::Variant::Type::Array: {
-            scopes::VariantArray arr(variant.get_array());
+            auto const& arr = variant.get_array();
             QVariantList result_list;
-            result_list.reserve(arr.size());
-            for (size_t i = 0; i < arr.size(); i++) {
-                result_list.append(scopeVariantToQVariant(arr[i]));
+            result_list.reserve(static_cast<int>(arr.size()));
+            for (auto const& v: arr) {
+                result_list.append(scopeVariantToQVariant(v));
             }
             return result_list;
         }
@@ -81,21 +115,22 @@ scopes::Variant qVariantToScopeVariant(QVariant const& variant)
         case QMetaType::Float:
             return scopes::Variant(variant.toDouble());
         case QMetaType::QString:
-            return scopes::Variant(variant.toString().toStdString());
+            return scopes::Variant(toStdString(*static_cast<QString const*>(variant.constData())));
         case QMetaType::QVariantMap: {
+            // iterate the container held by the variant; non-const access would detach (deep copy) it
+            auto const& m = *static_cast<QVariantMap const*>(variant.constData());
             scopes::VariantMap vm;
-            QVariantMap m(variant.toMap());
-            for (auto it = m.begin(); it != m.end(); ++it) {
-                vm[it.key().toStdString()] = qVariantToScopeVariant(it.value());
+            for (auto it = m.constBegin(); it != m.constEnd(); ++it) {
+                vm.emplace_hint(vm.end(), toStdString(it.key()), qVariantToScopeVariant(it.value()));
             }
             return scopes::Variant(vm);
         }
         case QMetaType::QVariantList: {
-            QVariantList l(variant.toList());
+            auto const& l = *static_cast<QVariantList const*>(variant.constData());
             scopes::VariantArray arr;
             arr.reserve(l.size());
-            for (int i = 0; i < l.size(); i++) {
-                arr.push_back(qVariantToScopeVariant(l[i]));
+            for (auto const& v: l) {
+                arr.push_back(qVariantToScopeVariant(v));
             }
             return scopes::Variant(arr);
         }
@@ -105,29 +140,71 @@ scopes::Variant qVariantToScopeVariant(QVariant const& variant)
     }
 }
 
-QVariant backgroundUriToVariant(QString const& uri)
+namespace
+{
+
+// Parsed color:/// and gradient:/// uris; the same few backgrounds are typically used by all
+// cards of a category, so rows share one (implicitly shared, never modified) map per uri.
+const int BACKGROUND_CACHE_SIZE = 100;
+
+QMutex backgroundCacheMutex;
+QCache<QString, QVariant> backgroundCache(BACKGROUND_CACHE_SIZE);
+
+QVariant parseBackgroundUri(QString const& uri)
 {
+    QVariantList elements;
+    QString type;
     if (uri.startsWith(QLatin1String("color:///"))) {
-        QVariantList elements;
+        type = QStringLiteral("color");
         elements.append(uri.mid(9));
-        QVariantMap m;
-        m[QStringLiteral("type")] = QStringLiteral("color");
-        m[QStringLiteral("elements")] = elements;
-        return m;
-    } else if (uri.startsWith(QLatin1String("gradient:///"))) {
+    } else {
+        type = QStringLiteral("gradient");
         QStringList parts = uri.mid(12).split(QStringLiteral("/"), QString::SkipEmptyParts);
-        QVariantList elements;
         elements.reserve(parts.size());
         for (int i = 0; i < parts.size(); i++) {
             elements.append(parts[i]);
         }
-        QVariantMap m;
-        m[QStringLiteral("type")] = QStringLiteral("gradient");
-        m[QStringLiteral("elements")] = elements;
-        return m;
-    } else {
+    }
+    QVariantMap m;
+    m[QStringLiteral("type")] = type;
+    m[QStringLiteral("elements")] = elements;
+    return m;
+}
+
+}
+
+QVariant backgroundUriToVariant(QString const& uri)
+{
+    if (!uri.startsWith(QLatin1String("color:///")) && !uri.startsWith(QLatin1String("gradient:///"))) {
         return QVariant(uri);
     }
+
+    QMutexLocker locker(&backgroundCacheMutex);
+    QVariant* cached = backgroundCache.object(uri);
+    if (cached) {
+        return *cached;
+    }
+    QVariant parsed(parseBackgroundUri(uri));
+    backgroundCache.insert(uri, new QVariant(parsed));
+    return parsed;
+}
+
+qint64 estimateResultSize(scopes::Result const& result)
+{
+    // called for every result delivered to a model, so only look at the common top-level string fields;
+    // serializing the whole result would copy all of it
+    static const char* const fields[] = {"uri", "dnd_uri", "title", "art", "subtitle", "summary", "mascot", "emblem"};
+
+    qint64 size = sizeof(scopes::CategorisedResult);
+    for (auto const field: fields) {
+        if (result.contains(field)) {
+            scopes::Variant const& value = result.value(field);
+            if (value.which() == scopes::Variant::Type::String) {
+                size += sizeof(scopes::Variant) + value.get_string().size();
+            }
+        }
+    }
+    return size;
 }
 
 Q_DECL_EXPORT QString uuidToString(QUuid const& uuid)
@@ -24,6 +24,7 @@
 #include <QVariant>
 #include <QUuid>
 
+#include <unity/scopes/Result.h>
 #include <unity/scopes/Variant.h>
 
 namespace scopes_ng
@@ -33,6 +34,8 @@ Q_DECL_EXPORT QVariant scopeVariantToQVariant(unity::scopes::Variant const& vari
 Q_DECL_EXPORT unity::scopes::Variant qVariantToScopeVariant(QVariant const& variant);
 Q_DECL_EXPORT QVariant backgroundUriToVariant(QString const& uri);
 Q_DECL_EXPORT QString uuidToString(QUuid const& uuid);
+// cheap, rough estimate of the memory used by a result, in bytes; only common string fields are counted
+Q_DECL_EXPORT qint64 estimateResultSize(unity::scopes::Result const& result);
 
 } // namespace scopes_ng
 
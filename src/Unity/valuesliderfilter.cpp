@@ -72,6 +72,7 @@ void ValueSliderFilter::setValue(double value)
             m_filter->update_state(*state, m_value = value);
 
             Q_EMIT valueChanged();
+            refreshActiveFiltersCount();
             Q_EMIT filterStateChanged();
         }
     }
@@ -111,6 +112,8 @@ void ValueSliderFilter::update(unity::scopes::FilterState::SPtr const& filterSta
         m_max = m_filter->max();
         Q_EMIT maxValueChanged();
     }
+
+    refreshActiveFiltersCount();
 }
 
 void ValueSliderFilter::update(unity::scopes::FilterBase::SCPtr const& filter)
@@ -130,6 +133,9 @@ void ValueSliderFilter::update(unity::scopes::FilterBase::SCPtr const& filter)
     }
 
     m_values->update(valueslider->labels(), valueslider->min(), valueslider->max());
+
+    // default value may have changed
+    refreshActiveFiltersCount();
 }
 
 int ValueSliderFilter::activeFiltersCount() const
@@ -142,6 +148,11 @@ int ValueSliderFilter::activeFiltersCount() const
     return 0;
 }
 
+void ValueSliderFilter::emitActiveFiltersCountChanged(int delta)
+{
+    Q_EMIT activeFiltersCountChanged(delta);
+}
+
 QString ValueSliderFilter::filterTag() const
 {
     return ""; // slider filter can't be a primary navigation filter
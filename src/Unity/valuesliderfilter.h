@@ -53,6 +53,10 @@ public:
 
 Q_SIGNALS:
     void filterStateChanged();
+    void activeFiltersCountChanged(int delta);
+
+protected:
+    void emitActiveFiltersCountChanged(int delta) override;
 
 private:
     QString m_id;
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QSignalSpy>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+#include <QTest>
+#include <scopes.h>
+#include <settingsmodel.h>
+#include <scope-harness/registry/pre-existing-registry.h>
+
+using namespace unity::scopeharness::registry;
+using namespace unity::shell::scopes;
+using namespace scopes_ng;
+
+class ChildScopesTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    SettingsModel* newSettingsModel()
+    {
+        return new SettingsModel(m_tempDir->path(), "mock-scope-departments", QVariant(), true, this, 0);
+    }
+
+    int rowOf(SettingsModel* settings, QString const& id) const
+    {
+        for (int i = 0; i < settings->rowCount(); i++) {
+            if (settings->data(settings->index(i), SettingsModelInterface::RoleSettingId).toString() == id) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // queries the child scopes the aggregator currently has through a new model
+    QVariant storedValue(QString const& id)
+    {
+        QScopedPointer<SettingsModel> settings(newSettingsModel());
+        QSignalSpy spy(settings.data(), SIGNAL(childScopesUpdated()));
+        settings->update_child_scopes(m_scopes->getAllMetadata());
+        if (!spy.wait()) {
+            return QVariant();
+        }
+        return settings->value(id);
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_registry.reset(new PreExistingRegistry(TEST_RUNTIME_CONFIG));
+        m_registry->start();
+
+        m_scopes.reset(new Scopes(nullptr));
+        QSignalSpy spy(m_scopes.data(), SIGNAL(loadedChanged()));
+        QVERIFY(spy.wait());
+        QCOMPARE(m_scopes->loaded(), true);
+    }
+
+    void cleanupTestCase()
+    {
+        m_scopes.reset();
+        m_registry.reset();
+    }
+
+    void init()
+    {
+        m_tempDir.reset(new QTemporaryDir);
+        m_settings = newSettingsModel();
+        QSignalSpy spy(m_settings, SIGNAL(childScopesUpdated()));
+        m_settings->update_child_scopes(m_scopes->getAllMetadata());
+        QVERIFY(spy.wait());
+        QCOMPARE(m_settings->count(), 2);
+        QCOMPARE(m_settings->value("mock-scope"), QVariant(true));
+    }
+
+    void cleanup()
+    {
+        // leave the aggregator with all child scopes enabled
+        QSignalSpy spy(m_settings, SIGNAL(settingsChanged()));
+        QVERIFY(m_settings->setData(m_settings->index(rowOf(m_settings, "mock-scope")), true, SettingsModelInterface::RoleValue));
+        QVERIFY(spy.wait());
+        QTRY_COMPARE(storedValue("mock-scope"), QVariant(true));
+
+        delete m_settings;
+        m_settings = nullptr;
+    }
+
+    void testSupersededReplyDropped()
+    {
+        const int row = rowOf(m_settings, "mock-scope");
+        QVERIFY(row >= 0);
+
+        // a reply that doesn't know about a toggle yet must not bring the old value back
+        QList<QVariant> values;
+        auto resetConnection = connect(m_settings, &SettingsModel::modelReset, this, [this, &values]() {
+            values << m_settings->value("mock-scope");
+        });
+        auto changeConnection = connect(m_settings, &SettingsModel::dataChanged, this, [this, &values]() {
+            values << m_settings->value("mock-scope");
+        });
+        QSignalSpy changedSpy(m_settings, SIGNAL(settingsChanged()));
+        QSignalSpy updatedSpy(m_settings, SIGNAL(childScopesUpdated()));
+        QVERIFY(m_settings->setData(m_settings->index(row), false, SettingsModelInterface::RoleValue));
+        m_settings->update_child_scopes(m_scopes->getAllMetadata());
+        QCOMPARE(m_settings->value("mock-scope"), QVariant(false));
+
+        // the child scopes are queried again once the write is done
+        QTRY_COMPARE(changedSpy.count(), 1);
+        QTRY_VERIFY(updatedSpy.count() >= 1);
+        disconnect(resetConnection);
+        disconnect(changeConnection);
+        QVERIFY(!values.contains(QVariant(true)));
+        QCOMPARE(m_settings->value("mock-scope"), QVariant(false));
+        QCOMPARE(storedValue("mock-scope"), QVariant(false));
+    }
+
+    void testUnchangedReplyKeepsModel()
+    {
+        // child scopes are queried on every search, an identical reply must leave the model alone
+        QSignalSpy resetSpy(m_settings, SIGNAL(modelReset()));
+        QSignalSpy dataSpy(m_settings, SIGNAL(dataChanged(QModelIndex, QModelIndex, QVector<int>)));
+        QSignalSpy updatedSpy(m_settings, SIGNAL(childScopesUpdated()));
+        m_settings->update_child_scopes(m_scopes->getAllMetadata());
+        QVERIFY(updatedSpy.wait());
+        QCOMPARE(resetSpy.count(), 0);
+        QCOMPARE(dataSpy.count(), 0);
+        QCOMPARE(m_settings->count(), 2);
+    }
+
+    void testWritesSerialized()
+    {
+        const int row = rowOf(m_settings, "mock-scope");
+        QVERIFY(row >= 0);
+
+        // toggles made while set_child_scopes() is running are sent once it finishes, so the last one wins
+        QSignalSpy changedSpy(m_settings, SIGNAL(settingsChanged()));
+        QVERIFY(m_settings->setData(m_settings->index(row), false, SettingsModelInterface::RoleValue));
+        QTest::qWait(0);
+        QVERIFY(m_settings->setData(m_settings->index(row), true, SettingsModelInterface::RoleValue));
+        QTest::qWait(0);
+        QVERIFY(m_settings->setData(m_settings->index(row), false, SettingsModelInterface::RoleValue));
+
+        QTRY_VERIFY(changedSpy.count() >= 1);
+        QVERIFY(changedSpy.count() <= 3);
+        QCOMPARE(m_settings->value("mock-scope"), QVariant(false));
+        QTRY_COMPARE(storedValue("mock-scope"), QVariant(false));
+    }
+
+private:
+    Registry::UPtr m_registry;
+    QScopedPointer<Scopes> m_scopes;
+    QScopedPointer<QTemporaryDir> m_tempDir;
+    SettingsModel* m_settings = nullptr;
+};
+
+QTEST_GUILESS_MAIN(ChildScopesTest)
+#include <childscopestest.moc>
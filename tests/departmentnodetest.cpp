@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QObject>
+#include <QTest>
+#include <QScopedPointer>
+#include <QSignalSpy>
+
+#include <department.h>
+#include <departmentnode.h>
+#include <unity/scopes/CannedQuery.h>
+#include <unity/scopes/Department.h>
+
+using namespace scopes_ng;
+using namespace unity::scopes;
+namespace sc = unity::scopes;
+
+class DepartmentNodeTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static sc::Department::SPtr createTree(std::string const& booksLabel, bool withAudioBooks)
+    {
+        CannedQuery query("mock-scope-departments");
+        sc::Department::SPtr root = sc::Department::create("", query, "All departments");
+
+        sc::Department::SPtr books = sc::Department::create("books", query, booksLabel);
+        books->add_subdepartment(sc::Department::create("books-kindle", query, "Kindle Books"));
+        if (withAudioBooks) {
+            books->add_subdepartment(sc::Department::create("books-audio", query, "Audiobooks"));
+        }
+        root->add_subdepartment(books);
+
+        sc::Department::SPtr movies = sc::Department::create("movies", query, "Movies, TV, Music");
+        movies->set_has_subdepartments();
+        root->add_subdepartment(movies);
+
+        return root;
+    }
+
+private Q_SLOTS:
+    void testFindNodeById()
+    {
+        DepartmentNode tree;
+        tree.initializeForDepartment(createTree("Books", true));
+
+        QCOMPARE(tree.findNodeById(""), &tree);
+        QVERIFY(tree.findNodeById("books-audio") != nullptr);
+        QCOMPARE(tree.findNodeById("books-audio")->label(), QString("Audiobooks"));
+        QVERIFY(tree.findNodeById("toys") == nullptr);
+
+        // lookups on a subtree only return its own nodes
+        DepartmentNode* books = tree.findNodeById("books");
+        QVERIFY(books != nullptr);
+        QCOMPARE(books->findNodeById("books-kindle"), tree.findNodeById("books-kindle"));
+        QVERIFY(books->findNodeById("movies") == nullptr);
+    }
+
+    void testUpdateReusesNodes()
+    {
+        DepartmentNode tree;
+        tree.initializeForDepartment(createTree("Books", true));
+
+        DepartmentNode* books = tree.findNodeById("books");
+        DepartmentNode* kindle = tree.findNodeById("books-kindle");
+        DepartmentNode* movies = tree.findNodeById("movies");
+
+        // nothing changed
+        {
+            QSet<QString> changedNodes;
+            QVERIFY(!tree.updateForDepartment(createTree("Books", true), changedNodes));
+            QVERIFY(changedNodes.isEmpty());
+        }
+
+        // label of a subdepartment changed
+        {
+            QSet<QString> changedNodes;
+            tree.updateForDepartment(createTree("All Books", true), changedNodes);
+            QCOMPARE(changedNodes, QSet<QString>() << "" << "books" << "books-kindle" << "books-audio");
+            QCOMPARE(tree.findNodeById("books"), books);
+            QCOMPARE(books->label(), QString("All Books"));
+        }
+
+        // a leaf was removed
+        {
+            QSet<QString> changedNodes;
+            tree.updateForDepartment(createTree("All Books", false), changedNodes);
+            QCOMPARE(changedNodes, QSet<QString>() << "books");
+            QVERIFY(tree.findNodeById("books-audio") == nullptr);
+            QCOMPARE(books->childCount(), 1);
+        }
+
+        QCOMPARE(tree.findNodeById("books"), books);
+        QCOMPARE(tree.findNodeById("books-kindle"), kindle);
+        QCOMPARE(tree.findNodeById("movies"), movies);
+    }
+
+    void testActiveSubdepartmentKeptOnReload()
+    {
+        DepartmentNode tree;
+        tree.initializeForDepartment(createTree("Books", true));
+
+        scopes_ng::Department model;
+        model.loadFromDepartmentNode(tree.findNodeById("books"));
+        model.markSubdepartmentActive("books-audio");
+        const QModelIndex audio(model.index(1));
+        QCOMPARE(model.data(audio, scopes_ng::Department::RoleNavigationId).toString(), QString("books-audio"));
+        QVERIFY(model.data(audio, scopes_ng::Department::RoleIsActive).toBool());
+
+        // relabelled parent: the active row is neither deactivated nor notified
+        QSignalSpy spy(&model, SIGNAL(dataChanged(QModelIndex, QModelIndex, QVector<int>)));
+        QSet<QString> changedNodes;
+        tree.updateForDepartment(createTree("All Books", true), changedNodes);
+        model.loadFromDepartmentNode(tree.findNodeById("books"));
+        model.markSubdepartmentActive("books-audio");
+        QVERIFY(model.data(audio, scopes_ng::Department::RoleIsActive).toBool());
+        QCOMPARE(spy.count(), 0);
+
+        // moving the active state notifies both rows once
+        model.markSubdepartmentActive("books-kindle");
+        QCOMPARE(spy.count(), 2);
+        QVERIFY(!model.data(audio, scopes_ng::Department::RoleIsActive).toBool());
+        QVERIFY(model.data(model.index(0), scopes_ng::Department::RoleIsActive).toBool());
+    }
+};
+
+QTEST_GUILESS_MAIN(DepartmentNodeTest)
+#include <departmentnodetest.moc>
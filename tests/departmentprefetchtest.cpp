@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QSignalSpy>
+#include <QScopedPointer>
+#include <QTest>
+#include <scopes.h>
+#include <scope.h>
+#include <queryscheduler.h>
+#include "categories.h"
+#include <scope-harness/registry/pre-existing-registry.h>
+#include <scope-harness/test-utils.h>
+#include <unity/shell/scopes/ResultsModelInterface.h>
+
+using namespace unity::scopeharness;
+using namespace unity::scopeharness::registry;
+using namespace scopes_ng;
+namespace uss = unity::shell::scopes;
+
+// The scheduler runs a single query at a time, and a blocking query of higher priority keeps
+// the prefetch searches queued until the test releases it.
+class DepartmentPrefetchTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString resultTitle() const
+    {
+        auto categories = m_scope->categories();
+        if (categories == nullptr || categories->rowCount() == 0) {
+            return QString();
+        }
+        auto model = categories->data(categories->index(0, 0),
+                Categories::RoleResultsSPtr).value<QSharedPointer<uss::ResultsModelInterface>>();
+        if (!model || model->rowCount() == 0) {
+            return QString();
+        }
+        return model->data(model->index(0, 0), uss::ResultsModelInterface::RoleTitle).toString();
+    }
+
+    void blockScheduler()
+    {
+        m_blocker.reset(new QObject);
+        m_scopes->queryScheduler()->scheduleQuery(m_blocker.data(), m_scope.data(), QueryScheduler::Priority::VisibleNeighbour,
+                []() { return true; }, []() {});
+        QTRY_COMPARE(m_scopes->queryScheduler()->runningCount(), 1);
+    }
+
+    void releaseScheduler()
+    {
+        m_scopes->queryScheduler()->unscheduleQuery(m_blocker.data());
+        m_blocker.reset();
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_registry.reset(new PreExistingRegistry(TEST_RUNTIME_CONFIG));
+        m_registry->start();
+    }
+
+    void cleanupTestCase()
+    {
+        m_registry.reset();
+    }
+
+    void init()
+    {
+        qputenv("UNITY_SCOPES_NO_PREPOPULATE_FIRST", "1");
+        qputenv("UNITY_SCOPES_TYPING_TIMEOUT_OVERRIDE", "0");
+        qputenv("UNITY_SCOPES_RESULTS_TTL_OVERRIDE", "60000");
+        qputenv("UNITY_SCOPES_MAX_CONCURRENT_QUERIES", "1");
+        qputenv("UNITY_SCOPES_DEPARTMENT_PREFETCH", "mock-scope-departments");
+
+        const QStringList favs {"scope://mock-scope-departments"};
+        TestUtils::setFavouriteScopes(favs);
+
+        m_scopes.reset(new Scopes(nullptr));
+
+        // wait till the registry spawns
+        QSignalSpy spy(m_scopes.data(), SIGNAL(loadedChanged()));
+        QVERIFY(spy.wait());
+        QCOMPARE(m_scopes->loaded(), true);
+
+        m_scope = m_scopes->getScopeById("mock-scope-departments");
+        QVERIFY(m_scope != nullptr);
+        QVERIFY(m_scope->departmentPrefetchEnabled());
+        m_scope->setActive(true);
+        blockScheduler();
+    }
+
+    void cleanup()
+    {
+        m_blocker.reset();
+        m_scopes.reset();
+        m_scope.reset();
+        qunsetenv("UNITY_SCOPES_RESULTS_TTL_OVERRIDE");
+        qunsetenv("UNITY_SCOPES_TYPING_TIMEOUT_OVERRIDE");
+        qunsetenv("UNITY_SCOPES_MAX_CONCURRENT_QUERIES");
+        qunsetenv("UNITY_SCOPES_DEPARTMENT_PREFETCH");
+    }
+
+    void testPrefetchedDepartmentRenderedFromCache()
+    {
+        TestUtils::performSearch(m_scope, "");
+
+        // with TTL under 5 minutes the first two subdepartments are prefetched in the background
+        QTRY_COMPARE(m_scopes->queryScheduler()->queuedCount(), 2);
+        QCOMPARE(m_scopes->queryScheduler()->runningCount(), 1);
+        releaseScheduler();
+        QTRY_COMPARE(m_scopes->queryScheduler()->queuedCount() + m_scopes->queryScheduler()->runningCount(), 0);
+
+        // navigating to a prefetched department doesn't search again
+        QSignalSpy progressSpy(m_scope.data(), SIGNAL(searchInProgressChanged()));
+        m_scope->setNavigationState("books");
+        QTRY_COMPARE(m_scope->currentNavigationId(), QString("books"));
+        QTRY_COMPARE(resultTitle(), QString("result for: \"\", department \"books\""));
+        QTest::qWait(500);
+        QCOMPARE(progressSpy.count(), 0);
+    }
+
+    void testPrefetchCancelledOnNavigation()
+    {
+        TestUtils::performSearch(m_scope, "");
+        QTRY_COMPARE(m_scopes->queryScheduler()->queuedCount(), 2);
+
+        // only the blocker is left after navigating elsewhere
+        m_scope->setNavigationState("electronics");
+        QCOMPARE(m_scopes->queryScheduler()->queuedCount() + m_scopes->queryScheduler()->runningCount(), 1);
+        TestUtils::waitForSearchFinish(m_scope);
+        QCOMPARE(m_scope->currentNavigationId(), QString("electronics"));
+
+        // prefetched results would have been rendered without a search
+        QSignalSpy progressSpy(m_scope.data(), SIGNAL(searchInProgressChanged()));
+        m_scope->setNavigationState("books");
+        QTRY_VERIFY(progressSpy.count() > 0);
+        TestUtils::waitForSearchFinish(m_scope);
+    }
+
+    void testSearchNotDelayedByPrefetch()
+    {
+        TestUtils::performSearch(m_scope, "");
+        QTRY_COMPARE(m_scopes->queryScheduler()->queuedCount(), 2);
+
+        // the search of the active scope doesn't share the scheduler slots with background queries
+        int competingQueries = -1;
+        QObject context;
+        QObject::connect(m_scope.data(), &Scope::searchInProgressChanged, &context, [this, &competingQueries]() {
+            if (m_scope->searchInProgress() && competingQueries < 0) {
+                competingQueries = m_scopes->queryScheduler()->runningCount();
+            }
+        });
+        TestUtils::performSearch(m_scope, "foo");
+        QCOMPARE(competingQueries, 0);
+
+        // the preempted blocker runs again once the search is done
+        QTRY_COMPARE(m_scopes->queryScheduler()->runningCount(), 1);
+    }
+
+private:
+    QScopedPointer<Scopes> m_scopes;
+    QScopedPointer<QObject> m_blocker;
+    Scope::Ptr m_scope;
+    Registry::UPtr m_registry;
+};
+
+QTEST_GUILESS_MAIN(DepartmentPrefetchTest)
+#include <departmentprefetchtest.moc>
@@ -220,6 +220,60 @@ private Q_SLOTS:
         QCOMPARE(filtersModel->data(idx1, unity::shell::scopes::FiltersInterface::Roles::RoleFilterId).toString(), QString("f2"));
     }
 
+    void testActiveFiltersCount()
+    {
+        {
+            QList<unity::scopes::FilterBase::SCPtr> backendFilters;
+            backendFilters.append(f1);
+            backendFilters.append(f2);
+
+            filtersModel->update(backendFilters);
+        }
+        QCOMPARE(filtersModel->activeFiltersCount(), 0);
+
+        QSignalSpy countSignal(filtersModel.data(), SIGNAL(activeFiltersCountChanged(int)));
+
+        // backend activates an option of each filter
+        {
+            unity::scopes::FilterState filterState;
+            f1->update_state(filterState, f1o1, true);
+            f2->update_state(filterState, f2o2, true);
+            filtersModel->update(filterState);
+        }
+        QCOMPARE(filtersModel->activeFiltersCount(), 2);
+        QCOMPARE(countSignal.count(), 2);
+
+        // user unchecks the option of the 1st filter
+        {
+            auto opf = filtersModel->data(filtersModel->index(0, 0), uss::FiltersInterface::Roles::RoleFilter).value<OptionSelectorFilter*>();
+            QVERIFY(opf != nullptr);
+            opf->options()->setChecked(0, false);
+        }
+        QCOMPARE(filtersModel->activeFiltersCount(), 1);
+
+        // removing the active filter removes its contribution
+        {
+            QList<unity::scopes::FilterBase::SCPtr> backendFilters;
+            backendFilters.append(f1);
+
+            filtersModel->update(backendFilters);
+        }
+        QCOMPARE(filtersModel->activeFiltersCount(), 0);
+
+        // re-adding it counts it again
+        {
+            QList<unity::scopes::FilterBase::SCPtr> backendFilters;
+            backendFilters.append(f1);
+            backendFilters.append(f2);
+
+            filtersModel->update(backendFilters);
+        }
+        QCOMPARE(filtersModel->activeFiltersCount(), 1);
+
+        filtersModel->clear();
+        QCOMPARE(filtersModel->activeFiltersCount(), 0);
+    }
+
 private:
     QScopedPointer<Filters> filtersModel;
     unity::scopes::OptionSelectorFilter::SPtr f1, f2;
@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QFile>
+#include <QObject>
+#include <QScopedPointer>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <geoip.h>
+#include <ubuntulocationservice.h>
+
+using namespace scopes_ng;
+
+namespace
+{
+
+const static QByteArray GEOIP_RESPONSE =
+        R"(<?xml version="1.0" encoding="UTF-8"?>
+<Response>
+  <Ip>192.0.2.1</Ip>
+  <Status>OK</Status>
+  <CountryCode>GB</CountryCode>
+  <CountryCode3>GBR</CountryCode3>
+  <CountryName>United Kingdom</CountryName>
+  <RegionCode>H9</RegionCode>
+  <RegionName>London, City of</RegionName>
+  <City>London</City>
+  <ZipPostalCode>EC1</ZipPostalCode>
+  <Latitude>51.5142</Latitude>
+  <Longitude>-0.0931</Longitude>
+  <AreaCode>0</AreaCode>
+  <TimeZone>Europe/London</TimeZone>
+</Response>
+)";
+
+// Minimal local stand-in for the GeoIP lookup service
+class GeoIpServer: public QTcpServer
+{
+public:
+    int requests = 0;
+    QByteArray response = GEOIP_RESPONSE;
+
+    GeoIpServer()
+    {
+        connect(this, &QTcpServer::newConnection, [this]() {
+            QTcpSocket* socket = nextPendingConnection();
+            connect(socket, &QTcpSocket::readyRead, [this, socket]() {
+                if (!socket->readAll().contains("\r\n\r\n"))
+                {
+                    return;
+                }
+                ++requests;
+                socket->write("HTTP/1.1 200 OK\r\nContent-Type: application/xml\r\nConnection: close\r\nContent-Length: ");
+                socket->write(QByteArray::number(response.size()));
+                socket->write("\r\n\r\n");
+                socket->write(response);
+                socket->disconnectFromHost();
+            });
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        });
+    }
+
+    QUrl url() const
+    {
+        return QUrl(QStringLiteral("http://127.0.0.1:%1/lookup").arg(serverPort()));
+    }
+};
+
+GeoIp::Result londonResult()
+{
+    GeoIp::Result result;
+    result.valid = true;
+    result.ip = "192.0.2.1";
+    result.countryCode = "GB";
+    result.countryName = "United Kingdom";
+    result.city = "London";
+    result.latitude = 51.5142;
+    result.longitude = -0.0931;
+    result.timeZone = "Europe/London";
+    return result;
+}
+
+// Exposes the GeoIP lookup interval of the location service
+class TestLocationService: public UbuntuLocationService
+{
+public:
+    TestLocationService(const GeoIp::Ptr& geoIp)
+        : UbuntuLocationService(geoIp)
+    {
+    }
+
+    int geoIpInterval() const
+    {
+        return m_geoIpInterval;
+    }
+};
+
+}
+
+class GeoIpTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        qRegisterMetaType<GeoIp::Result>();
+    }
+
+    void init()
+    {
+        m_cacheDir.reset(new QTemporaryDir);
+        QVERIFY(m_cacheDir->isValid());
+        m_cachePath = m_cacheDir->path() + "/geoip.cache";
+        qputenv("UNITY_SCOPES_GEOIP_CACHE", m_cachePath.toLocal8Bit());
+    }
+
+    void cleanup()
+    {
+        qunsetenv("UNITY_SCOPES_GEOIP_CACHE");
+        m_cacheDir.reset();
+    }
+
+    void testLookup()
+    {
+        GeoIpServer server;
+        QVERIFY(server.listen(QHostAddress::LocalHost));
+
+        GeoIp geoIp(server.url());
+        QSignalSpy spy(&geoIp, SIGNAL(finished(const Result&)));
+        geoIp.start();
+        QVERIFY(spy.wait());
+        QCOMPARE(server.requests, 1);
+
+        auto result = spy.takeFirst().at(0).value<GeoIp::Result>();
+        QVERIFY(result.valid);
+        QCOMPARE(result.ip, QString("192.0.2.1"));
+        QCOMPARE(result.countryCode, QString("GB"));
+        QCOMPARE(result.countryCode3, QString("GBR"));
+        QCOMPARE(result.city, QString("London"));
+        QCOMPARE(result.latitude, 51.5142);
+        QCOMPARE(result.longitude, -0.0931);
+        QCOMPARE(result.timeZone, QString("Europe/London"));
+    }
+
+    void testFailedLookup()
+    {
+        GeoIpServer server;
+        QVERIFY(server.listen(QHostAddress::LocalHost));
+        const QUrl url = server.url();
+        server.close();
+
+        GeoIp geoIp(url);
+        QSignalSpy spy(&geoIp, SIGNAL(finished(const Result&)));
+        geoIp.start();
+        QVERIFY(spy.wait());
+        QVERIFY(!spy.takeFirst().at(0).value<GeoIp::Result>().valid);
+    }
+
+    void testUrlOverride()
+    {
+        qputenv("UNITY_SCOPES_GEOIP_URL", "http://127.0.0.1:1234/lookup");
+        QCOMPARE(GeoIp::defaultUrl(), QUrl("http://127.0.0.1:1234/lookup"));
+        qunsetenv("UNITY_SCOPES_GEOIP_URL");
+        QCOMPARE(GeoIp::defaultUrl(), QUrl("http://geoip.ubuntu.com/lookup"));
+    }
+
+    void testCache()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.path() + "/sub/geoip.cache";
+
+        GeoIp::Result result;
+        QDateTime timestamp;
+        QVERIFY(!GeoIp::loadCache(path, result, timestamp));
+
+        // invalid results are never cached
+        QVERIFY(!GeoIp::saveCache(path, GeoIp::Result(), QDateTime::currentDateTimeUtc()));
+
+        const QDateTime now = QDateTime::currentDateTimeUtc();
+        QVERIFY(GeoIp::saveCache(path, londonResult(), now));
+        QVERIFY(GeoIp::loadCache(path, result, timestamp));
+        QVERIFY(result == londonResult());
+        QCOMPARE(timestamp, now);
+    }
+
+    void testInvalidCache()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.path() + "/geoip.cache";
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("not a cache");
+        file.close();
+
+        GeoIp::Result result;
+        QDateTime timestamp;
+        QVERIFY(!GeoIp::loadCache(path, result, timestamp));
+        QVERIFY(!result.valid);
+    }
+
+    void testServiceUsesCachedResult()
+    {
+        // the lookup fails, so only the cache can provide the location
+        GeoIpServer server;
+        QVERIFY(server.listen(QHostAddress::LocalHost));
+        const QUrl url = server.url();
+        server.close();
+
+        QVERIFY(GeoIp::saveCache(m_cachePath, londonResult(), QDateTime::currentDateTimeUtc().addSecs(-3600)));
+        {
+            UbuntuLocationService service(GeoIp::Ptr(new GeoIp(url)));
+            QVERIFY(service.hasGeoIpLocation());
+            QCOMPARE(service.location().city(), std::string("London"));
+            QSignalSpy spy(&service, SIGNAL(geoIpLookupFinished()));
+            QVERIFY(spy.wait());
+            QVERIFY(service.hasGeoIpLocation());
+        }
+
+        // results older than a day aren't used
+        QVERIFY(GeoIp::saveCache(m_cachePath, londonResult(), QDateTime::currentDateTimeUtc().addDays(-2)));
+        {
+            UbuntuLocationService service(GeoIp::Ptr(new GeoIp(url)));
+            QVERIFY(!service.hasGeoIpLocation());
+        }
+    }
+
+    void testServiceBacksOffUnchangedLookups()
+    {
+        GeoIpServer server;
+        QVERIFY(server.listen(QHostAddress::LocalHost));
+
+        GeoIp::Ptr geoIp(new GeoIp(server.url()));
+        TestLocationService service(geoIp);
+        QSignalSpy spy(&service, SIGNAL(geoIpLookupFinished()));
+        QVERIFY(spy.wait());
+        QCOMPARE(server.requests, 1);
+        QVERIFY(service.hasGeoIpLocation());
+        QCOMPARE(service.geoIpInterval(), 60000);
+
+        // the result is cached for the next session
+        GeoIp::Result cached;
+        QDateTime timestamp;
+        QVERIFY(GeoIp::loadCache(m_cachePath, cached, timestamp));
+        QVERIFY(cached == londonResult());
+
+        // the interval doubles while the result doesn't change, up to 30 minutes
+        for (int interval: {120000, 240000, 480000, 960000, 1800000, 1800000})
+        {
+            geoIp->start();
+            QVERIFY(spy.wait());
+            QCOMPARE(service.geoIpInterval(), interval);
+        }
+
+        // and starts over when it does
+        server.response.replace("<City>London</City>", "<City>Westminster</City>");
+        geoIp->start();
+        QVERIFY(spy.wait());
+        QCOMPARE(service.geoIpInterval(), 60000);
+        QCOMPARE(service.location().city(), std::string("Westminster"));
+        geoIp->start();
+        QVERIFY(spy.wait());
+        QCOMPARE(service.geoIpInterval(), 120000);
+    }
+
+    void testActivationSkipsRecentLookup()
+    {
+        GeoIpServer server;
+        QVERIFY(server.listen(QHostAddress::LocalHost));
+
+        GeoIp::Ptr geoIp(new GeoIp(server.url()));
+        UbuntuLocationService service(geoIp);
+        QSignalSpy spy(&service, SIGNAL(geoIpLookupFinished()));
+        QVERIFY(spy.wait());
+        QCOMPARE(server.requests, 1);
+
+        // the result of the startup lookup is recent enough for a scope being activated
+        auto token = service.activate();
+        QTRY_VERIFY(service.isActive());
+        QVERIFY(!spy.wait(500));
+        QCOMPARE(server.requests, 1);
+    }
+
+private:
+    QScopedPointer<QTemporaryDir> m_cacheDir;
+    QString m_cachePath;
+};
+
+QTEST_GUILESS_MAIN(GeoIpTest)
+#include <geoiptest.moc>
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QTest>
+
+#include <lazyvariant.h>
+#include <utils.h>
+
+using namespace scopes_ng;
+using namespace unity;
+
+class LazyVariantTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static std::shared_ptr<const scopes::Variant> createPayload()
+    {
+        scopes::VariantMap inner;
+        inner["author"] = scopes::Variant("Joe");
+        inner["likes"] = scopes::Variant(42);
+
+        scopes::VariantArray actions;
+        actions.push_back(scopes::Variant("like"));
+        actions.push_back(scopes::Variant(inner));
+
+        scopes::VariantMap payload;
+        payload["title"] = scopes::Variant("foo");
+        payload["rating"] = scopes::Variant(3.5);
+        payload["actions"] = scopes::Variant(actions);
+        payload["details"] = scopes::Variant(inner);
+        return std::make_shared<const scopes::Variant>(payload);
+    }
+
+private Q_SLOTS:
+    void testScalars()
+    {
+        // scalars are converted straight away
+        QCOMPARE(LazyVariant::fromScopeVariant(std::make_shared<const scopes::Variant>("foo")), QVariant(QString("foo")));
+        QCOMPARE(LazyVariant::fromScopeVariant(std::make_shared<const scopes::Variant>(7)), QVariant(7));
+        QVERIFY(LazyVariant::fromScopeVariant(std::make_shared<const scopes::Variant>()).isNull());
+        QVERIFY(LazyVariant::fromScopeVariant(nullptr).isNull());
+    }
+
+    void testDictAccess()
+    {
+        QObject parent;
+        QVariant v(LazyVariant::fromScopeVariant(createPayload(), &parent));
+        LazyVariant* lazy = v.value<LazyVariant*>();
+        QVERIFY(lazy != nullptr);
+        QCOMPARE(lazy->parent(), &parent);
+        QVERIFY(lazy->isDict());
+        QVERIFY(!lazy->isArray());
+        QCOMPARE(lazy->count(), 4);
+        QCOMPARE(lazy->keys(), QStringList() << "actions" << "details" << "rating" << "title");
+        QVERIFY(lazy->contains("title"));
+        QVERIFY(!lazy->contains("missing"));
+        QCOMPARE(lazy->value("title").toString(), QString("foo"));
+        QCOMPARE(lazy->value("rating").toDouble(), 3.5);
+        QVERIFY(lazy->value("missing").isNull());
+        QVERIFY(lazy->at(0).isNull());
+
+        QScopedPointer<LazyVariant> details(lazy->value("details").value<LazyVariant*>());
+        QVERIFY(details);
+        QCOMPARE(details->value("author").toString(), QString("Joe"));
+        QCOMPARE(details->value("likes").toInt(), 42);
+    }
+
+    void testArrayAccess()
+    {
+        QObject parent;
+        LazyVariant* lazy = LazyVariant::fromScopeVariant(createPayload(), &parent).value<LazyVariant*>();
+        QVERIFY(lazy != nullptr);
+
+        QScopedPointer<LazyVariant> actions(lazy->value("actions").value<LazyVariant*>());
+        QVERIFY(actions);
+        QVERIFY(actions->isArray());
+        QCOMPARE(actions->count(), 2);
+        QVERIFY(actions->keys().isEmpty());
+        QCOMPARE(actions->at(0).toString(), QString("like"));
+        QVERIFY(actions->at(2).isNull());
+        QVERIFY(actions->at(-1).isNull());
+
+        // children stay valid after their parent wrapper is gone
+        QScopedPointer<LazyVariant> inner(actions->at(1).value<LazyVariant*>());
+        actions.reset();
+        QVERIFY(inner);
+        QCOMPARE(inner->value("author").toString(), QString("Joe"));
+    }
+
+    void testConversion()
+    {
+        auto payload = createPayload();
+        QObject parent;
+        QVariant v(LazyVariant::fromScopeVariant(payload, &parent));
+        QCOMPARE(LazyVariant::toQVariant(v), scopeVariantToQVariant(*payload));
+        QCOMPARE(v.value<LazyVariant*>()->toVariant(), scopeVariantToQVariant(*payload));
+
+        // plain values are passed through
+        QCOMPARE(LazyVariant::toQVariant(QVariant(5)), QVariant(5));
+    }
+
+    void testScopeVariant()
+    {
+        auto payload = createPayload();
+        QObject parent;
+        LazyVariant* lazy = LazyVariant::fromScopeVariant(payload, &parent).value<LazyVariant*>();
+        QVERIFY(lazy != nullptr);
+
+        // the wrapped value is shared, and can be compared to decide whether a wrapper is still up to date
+        QCOMPARE(&lazy->scopeVariant(), payload.get());
+        QVERIFY(lazy->scopeVariant() == *createPayload());
+        QVERIFY(!(lazy->scopeVariant() == scopes::Variant(scopes::VariantMap())));
+    }
+};
+
+QTEST_GUILESS_MAIN(LazyVariantTest)
+#include <lazyvarianttest.moc>
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QObject>
+#include <QTest>
+
+#include <locationrequerypolicy.h>
+
+using namespace scopes_ng;
+
+class LocationRequeryPolicyTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testFirstFix()
+    {
+        LocationRequeryPolicy policy(1000.0, 200.0, 600000);
+        QVERIFY(!policy.update(QGeoCoordinate(), 0));
+        QVERIFY(policy.update(QGeoCoordinate(51.5, -0.1), 0));
+        QCOMPARE(policy.reference(), QGeoCoordinate(51.5, -0.1));
+    }
+
+    void testDistance()
+    {
+        LocationRequeryPolicy policy(1000.0, 200.0, 600000);
+        const QGeoCoordinate start(51.5, -0.1);
+        policy.setReference(start, 0);
+
+        // small movements are ignored, even if they add up
+        QVERIFY(!policy.update(start.atDistanceAndAzimuth(500.0, 90.0), 1000));
+        QVERIFY(!policy.update(start.atDistanceAndAzimuth(900.0, 90.0), 2000));
+        QCOMPARE(policy.reference(), start);
+
+        const QGeoCoordinate moved(start.atDistanceAndAzimuth(1500.0, 90.0));
+        QVERIFY(policy.update(moved, 3000));
+        QCOMPARE(policy.reference(), moved);
+
+        // the new position is the reference now
+        QVERIFY(!policy.update(moved.atDistanceAndAzimuth(500.0, 0.0), 4000));
+    }
+
+    void testInterval()
+    {
+        LocationRequeryPolicy policy(1000.0, 200.0, 600000);
+        const QGeoCoordinate start(51.5, -0.1);
+        policy.setReference(start, 0);
+
+        QVERIFY(!policy.update(start.atDistanceAndAzimuth(500.0, 90.0), 599999));
+        // noise doesn't trigger a requery even when the interval has passed
+        QVERIFY(!policy.update(start.atDistanceAndAzimuth(100.0, 90.0), 600000));
+        QVERIFY(policy.update(start.atDistanceAndAzimuth(500.0, 90.0), 600000));
+    }
+};
+
+QTEST_GUILESS_MAIN(LocationRequeryPolicyTest)
+#include <locationrequerypolicytest.moc>
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QSignalSpy>
+#include <QScopedPointer>
+#include <QTest>
+#include <scopes.h>
+#include <scope.h>
+#include <scope-harness/registry/pre-existing-registry.h>
+#include <scope-harness/test-utils.h>
+
+using namespace unity::scopeharness;
+using namespace unity::scopeharness::registry;
+using namespace scopes_ng;
+
+class MemoryBudgetTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    void createScopes()
+    {
+        m_scopes.reset(new Scopes(nullptr));
+
+        // wait till the registry spawns
+        QSignalSpy spy(m_scopes.data(), SIGNAL(loadedChanged()));
+        QVERIFY(spy.wait());
+        QCOMPARE(m_scopes->loaded(), true);
+    }
+
+    // makes the scope the only active one and searches in it
+    Scope::Ptr viewScope(QString const& id)
+    {
+        for (int i = 0; i < m_scopes->count(); i++) {
+            m_scopes->getScopeByRow(i)->setActive(false);
+        }
+        Scope::Ptr scope = m_scopes->getScopeById(id);
+        if (scope) {
+            scope->setActive(true);
+            TestUtils::performSearch(scope, "a");
+        }
+        return scope;
+    }
+
+    qint64 totalUsage() const
+    {
+        qint64 usage = 0;
+        for (int i = 0; i < m_scopes->count(); i++) {
+            usage += m_scopes->getScopeByRow(i)->memoryUsage();
+        }
+        return usage;
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_registry.reset(new PreExistingRegistry(TEST_RUNTIME_CONFIG));
+        m_registry->start();
+    }
+
+    void cleanupTestCase()
+    {
+        m_registry.reset();
+    }
+
+    void init()
+    {
+        qputenv("UNITY_SCOPES_NO_PREPOPULATE_FIRST", "1");
+        qputenv("UNITY_SCOPES_TYPING_TIMEOUT_OVERRIDE", "0");
+        qputenv("UNITY_SCOPES_MEMORY_BUDGET", "0");
+
+        const QStringList favs {"scope://mock-scope-ttl", "scope://mock-scope", "scope://mock-scope-manyresults"};
+        TestUtils::setFavouriteScopes(favs);
+
+        createScopes();
+    }
+
+    void cleanup()
+    {
+        m_scopes.reset();
+        qunsetenv("UNITY_SCOPES_MEMORY_BUDGET");
+        qunsetenv("UNITY_SCOPES_TYPING_TIMEOUT_OVERRIDE");
+    }
+
+    void testBudgetFromEnvironment()
+    {
+        QCOMPARE(m_scopes->memoryBudget(), qint64(0));
+
+        qputenv("UNITY_SCOPES_MEMORY_BUDGET", "3");
+        createScopes();
+        QCOMPARE(m_scopes->memoryBudget(), qint64(3 * 1024 * 1024));
+
+        // a default budget applies without the variable
+        qunsetenv("UNITY_SCOPES_MEMORY_BUDGET");
+        createScopes();
+        QVERIFY(m_scopes->memoryBudget() > 0);
+    }
+
+    void testUsageTracksResults()
+    {
+        Scope::Ptr scope = viewScope("mock-scope-manyresults");
+        QVERIFY(scope);
+        const qint64 usage = scope->memoryUsage();
+        QVERIFY(usage > 0);
+        QTRY_COMPARE(m_scopes->memoryUsage(), totalUsage());
+
+        // the displayed results are shared with the cached search, which keeps its size when the models go away
+        scope->setActive(false);
+        scope->hibernate();
+        QVERIFY(scope->hibernated());
+        QCOMPARE(scope->memoryUsage(), usage);
+
+        scope->invalidateSearchCache();
+        QCOMPARE(scope->memoryUsage(), qint64(0));
+    }
+
+    void testEvictionOrder()
+    {
+        Scope::Ptr first = viewScope("mock-scope-ttl");
+        QTest::qWait(10);
+        Scope::Ptr second = viewScope("mock-scope");
+        QTest::qWait(10);
+        Scope::Ptr active = viewScope("mock-scope-manyresults");
+        QVERIFY(first && second && active);
+        QVERIFY(!first->isActive());
+        QVERIFY(!second->isActive());
+
+        const qint64 activeUsage = active->memoryUsage();
+        QVERIFY(first->memoryUsage() > 0);
+        QVERIFY(second->memoryUsage() > 0);
+        QVERIFY(activeUsage > 0);
+
+        // inactive scopes are hibernated, least recently viewed first
+        m_scopes->setMemoryBudget(totalUsage() - 1);
+        QTRY_VERIFY(first->hibernated());
+        QTRY_VERIFY(m_scopes->memoryUsage() <= m_scopes->memoryBudget());
+
+        // hibernated scopes keep the displayed search; these snapshots go in the same order
+        second->hibernate();
+        const qint64 secondSnapshot = second->memoryUsage();
+        QVERIFY(secondSnapshot > 0);
+        m_scopes->setMemoryBudget(totalUsage() - 1);
+        QTRY_COMPARE(first->memoryUsage(), qint64(0));
+        QTest::qWait(600);
+        QCOMPARE(second->memoryUsage(), secondSnapshot);
+
+        // the active scope is never released
+        m_scopes->setMemoryBudget(1);
+        QTRY_COMPARE(second->memoryUsage(), qint64(0));
+        QVERIFY(!active->hibernated());
+        QCOMPARE(active->memoryUsage(), activeUsage);
+        QTRY_COMPARE(m_scopes->memoryUsage(), activeUsage);
+    }
+
+private:
+    QScopedPointer<Scopes> m_scopes;
+    Registry::UPtr m_registry;
+};
+
+QTEST_GUILESS_MAIN(MemoryBudgetTest)
+#include <memorybudgettest.moc>
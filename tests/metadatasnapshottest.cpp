@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QFile>
+#include <QObject>
+#include <QScopedPointer>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include <categories.h>
+#include <metadatasnapshot.h>
+#include <scope.h>
+#include <scopes.h>
+
+#include <scope-harness/registry/pre-existing-registry.h>
+#include <scope-harness/test-utils.h>
+
+using namespace scopes_ng;
+using namespace unity::scopeharness;
+using namespace unity::scopeharness::registry;
+
+class MetadataSnapshotTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    Registry::UPtr m_registry;
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_registry.reset(new PreExistingRegistry(TEST_RUNTIME_CONFIG));
+        m_registry->start();
+    }
+
+    void cleanupTestCase()
+    {
+        m_registry.reset();
+    }
+
+    void testSaveAndLoad()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.path() + "/sub/metadata.snapshot";
+
+        ScopeSnapshot music;
+        music.id = "music";
+        music.name = "Music";
+        music.icon = "/usr/share/icons/music.svg";
+        music.customizations.insert("foreground-color", "red");
+
+        ScopeSnapshot hidden;
+        hidden.id = "hidden";
+        hidden.name = "Hidden";
+        hidden.invisible = true;
+
+        QMap<QString, ScopeSnapshot> scopes;
+        scopes.insert(music.id, music);
+        scopes.insert(hidden.id, hidden);
+        QVERIFY(MetadataSnapshot::save(path, scopes));
+
+        auto loaded = MetadataSnapshot::load(path);
+        QCOMPARE(loaded.size(), 2);
+        QCOMPARE(loaded["music"].name, QString("Music"));
+        QCOMPARE(loaded["music"].icon, QString("/usr/share/icons/music.svg"));
+        QCOMPARE(loaded["music"].searchHint, QString());
+        QCOMPARE(loaded["music"].customizations.value("foreground-color").toString(), QString("red"));
+        QVERIFY(!loaded["music"].invisible);
+        QVERIFY(loaded["hidden"].invisible);
+    }
+
+    void testInvalidSnapshot()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.path() + "/metadata.snapshot";
+
+        QVERIFY(MetadataSnapshot::load(path).isEmpty());
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("not a snapshot");
+        file.close();
+        QVERIFY(MetadataSnapshot::load(path).isEmpty());
+
+        // truncated snapshot is rejected as a whole
+        ScopeSnapshot scope;
+        scope.id = "music";
+        QMap<QString, ScopeSnapshot> scopes;
+        scopes.insert(scope.id, scope);
+        QVERIFY(MetadataSnapshot::save(path, scopes));
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        file.resize(file.size() - 2);
+        file.close();
+        QVERIFY(MetadataSnapshot::load(path).isEmpty());
+    }
+
+    void testActivateBeforeDiscovery()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString path = dir.path() + "/metadata.snapshot";
+
+        ScopeSnapshot snapshot;
+        snapshot.id = "mock-scope";
+        snapshot.name = "Mock";
+        // location-aware
+        ScopeSnapshot infoSnapshot;
+        infoSnapshot.id = "mock-scope-info";
+        infoSnapshot.name = "Info";
+        QMap<QString, ScopeSnapshot> snapshots;
+        snapshots.insert(snapshot.id, snapshot);
+        snapshots.insert(infoSnapshot.id, infoSnapshot);
+        QVERIFY(MetadataSnapshot::save(path, snapshots));
+
+        qputenv("UNITY_SCOPES_METADATA_SNAPSHOT", path.toLocal8Bit());
+        qputenv("UNITY_SCOPES_NO_WAIT_LOCATION", "1");
+        TestUtils::setFavouriteScopes(QStringList() << "scope://mock-scope" << "scope://mock-scope-info");
+        QScopedPointer<Scopes> scopes(new Scopes(nullptr));
+        qunsetenv("UNITY_SCOPES_METADATA_SNAPSHOT");
+        qunsetenv("UNITY_SCOPES_NO_WAIT_LOCATION");
+
+        // the scopes are there right away, but the registry hasn't been listed yet
+        QCOMPARE(scopes->loaded(), true);
+        QCOMPARE(scopes->rowCount(), 2);
+        Scope::Ptr scope = scopes->getScopeByRow(0);
+        QVERIFY(bool(scope));
+        QCOMPARE(scope->id(), QString("mock-scope"));
+        QCOMPARE(scope->name(), QString("Mock"));
+        QVERIFY(!scope->proxy());
+        QVERIFY(scope->settings() == nullptr);
+
+        scope->setActive(true);
+        scope->refresh();
+        QCOMPARE(scope->searchInProgress(), true);
+
+        // the search is dispatched once the scope is discovered
+        QTRY_VERIFY(bool(scope->proxy()));
+        QTRY_COMPARE(scope->searchInProgress(), false);
+        QCOMPARE(scope->name(), QString("mock.DisplayName"));
+        QVERIFY(scope->categories()->rowCount() > 0);
+
+        // snapshot scopes share the location service with discovered ones
+        Scope::Ptr infoScope = scopes->getScopeByRow(1);
+        QVERIFY(bool(infoScope));
+        QCOMPARE(infoScope->id(), QString("mock-scope-info"));
+        QVERIFY(bool(infoScope->proxy()));
+        scope->setActive(false);
+        infoScope->setActive(true);
+        TestUtils::performSearch(infoScope, "no_location");
+        QCOMPARE(infoScope->status(), unity::shell::scopes::ScopeInterface::Status::NoLocationData);
+    }
+};
+
+QTEST_GUILESS_MAIN(MetadataSnapshotTest)
+#include <metadatasnapshottest.moc>
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QPointer>
+#include <QQmlEngine>
+#include <QSignalSpy>
+#include <QScopedPointer>
+#include <QTest>
+#include <department.h>
+#include <scopes.h>
+#include <scope.h>
+#include <scope-harness/registry/pre-existing-registry.h>
+#include <scope-harness/test-utils.h>
+
+using namespace unity::scopeharness;
+using namespace unity::scopeharness::registry;
+using namespace scopes_ng;
+
+class NavigationModelsTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    QPointer<Department> navigation(QString const& navId)
+    {
+        return QPointer<Department>(qobject_cast<Department*>(m_scope->getNavigation(navId)));
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_registry.reset(new PreExistingRegistry(TEST_RUNTIME_CONFIG));
+        m_registry->start();
+    }
+
+    void cleanupTestCase()
+    {
+        m_registry.reset();
+    }
+
+    void init()
+    {
+        qputenv("UNITY_SCOPES_NO_PREPOPULATE_FIRST", "1");
+        qputenv("UNITY_SCOPES_TYPING_TIMEOUT_OVERRIDE", "0");
+
+        const QStringList favs {"scope://mock-scope-departments"};
+        TestUtils::setFavouriteScopes(favs);
+
+        m_scopes.reset(new Scopes(nullptr));
+
+        // wait till the registry spawns
+        QSignalSpy spy(m_scopes.data(), SIGNAL(loadedChanged()));
+        QVERIFY(spy.wait());
+        QCOMPARE(m_scopes->loaded(), true);
+
+        m_scope = m_scopes->getScopeById("mock-scope-departments");
+        QVERIFY(m_scope != nullptr);
+        m_scope->setActive(true);
+        TestUtils::performSearch(m_scope, "");
+    }
+
+    void cleanup()
+    {
+        m_scopes.reset();
+        m_scope.reset();
+        qunsetenv("UNITY_SCOPES_TYPING_TIMEOUT_OVERRIDE");
+    }
+
+    void testModelsShared()
+    {
+        auto root = navigation("");
+        QVERIFY(root);
+        QCOMPARE(navigation("").data(), root.data());
+        QCOMPARE(QQmlEngine::objectOwnership(root.data()), QQmlEngine::CppOwnership);
+        QVERIFY(navigation("books").data() != root.data());
+    }
+
+    void testLeastRecentlyUsedModelDeleted()
+    {
+        auto root = navigation("");
+        auto books = navigation("books");
+        QVERIFY(root);
+        QVERIFY(books);
+
+        // five models are kept, the least recently used one is deleted when a sixth is requested
+        QCOMPARE(navigation("").data(), root.data());
+        for (auto const& id: {"movies", "electronics", "home"}) {
+            QVERIFY(navigation(id));
+        }
+        QVERIFY(navigation("toys"));
+        QTRY_VERIFY(books.isNull());
+        QVERIFY(root);
+    }
+
+    void testModelsDeletedOnHibernation()
+    {
+        auto root = navigation("");
+        auto books = navigation("books");
+        QVERIFY(root);
+        QVERIFY(books);
+
+        m_scope->setActive(false);
+        m_scope->hibernate();
+        QVERIFY(m_scope->hibernated());
+        QTRY_VERIFY(root.isNull());
+        QVERIFY(books.isNull());
+
+        // the scope hands out new models once it searched again
+        m_scope->setActive(true);
+        QTRY_VERIFY(!m_scope->searchInProgress() && m_scope->getNavigation("") != nullptr);
+    }
+
+    void testModelsDeletedWithScope()
+    {
+        auto root = navigation("");
+        QVERIFY(root);
+        m_scopes.reset();
+        m_scope.reset();
+        QTRY_VERIFY(root.isNull());
+    }
+
+private:
+    Registry::UPtr m_registry;
+    QScopedPointer<Scopes> m_scopes;
+    Scope::Ptr m_scope;
+};
+
+QTEST_GUILESS_MAIN(NavigationModelsTest)
+#include <navigationmodelstest.moc>
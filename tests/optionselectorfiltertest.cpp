@@ -26,6 +26,9 @@
 
 #include <unity/scopes/OptionSelectorFilter.h>
 
+#include <algorithm>
+#include <vector>
+
 using namespace scopes_ng;
 namespace uss = unity::shell::scopes;
 
@@ -251,6 +254,120 @@ private Q_SLOTS:
 
     }
 
+    void benchmarkSyncManyOptions()
+    {
+        const int numOptions = 1000;
+
+        // fa has all the options in order; fb has the last 100 options moved to the front,
+        // every 10th option removed and every 7th option relabeled.
+        unity::scopes::OptionSelectorFilter::SPtr fa = unity::scopes::OptionSelectorFilter::create("f3", "Filter3", true);
+        unity::scopes::OptionSelectorFilter::SPtr fb = unity::scopes::OptionSelectorFilter::create("f3", "Filter3", true);
+        for (int i = 0; i < numOptions; i++) {
+            fa->add_option("o" + std::to_string(i), "Option" + std::to_string(i));
+        }
+        for (int i = numOptions - 100; i < numOptions; i++) {
+            fb->add_option("o" + std::to_string(i), "Option" + std::to_string(i));
+        }
+        for (int i = 0; i < numOptions - 100; i++) {
+            if (i % 10 == 5) {
+                continue;
+            }
+            fb->add_option("o" + std::to_string(i), (i % 7 == 0 ? "Relabeled" : "Option") + std::to_string(i));
+        }
+
+        QList<unity::scopes::FilterBase::SCPtr> filtersA;
+        filtersA.append(fa);
+        QList<unity::scopes::FilterBase::SCPtr> filtersB;
+        filtersB.append(fb);
+
+        filtersModel->update(filtersA);
+        QCOMPARE(filtersModel->rowCount(), 1);
+
+        auto opf = filtersModel->data(filtersModel->index(0, 0), uss::FiltersInterface::Roles::RoleFilter).value<OptionSelectorFilter*>();
+        QVERIFY(opf != nullptr);
+        auto opts = opf->options();
+        QVERIFY(opts != nullptr);
+        QCOMPARE(opts->rowCount(), numOptions);
+
+        QBENCHMARK {
+            filtersModel->update(filtersB);
+            filtersModel->update(filtersA);
+        }
+
+        filtersModel->update(filtersB);
+        QCOMPARE(opts->rowCount(), numOptions - 90);
+        QCOMPARE(opts->data(opts->index(0, 0), uss::OptionSelectorOptionsInterface::Roles::RoleOptionId).toString(), QString("o900"));
+        QCOMPARE(opts->data(opts->index(100, 0), uss::OptionSelectorOptionsInterface::Roles::RoleOptionId).toString(), QString("o0"));
+        QCOMPARE(opts->data(opts->index(100, 0), uss::OptionSelectorOptionsInterface::Roles::RoleOptionLabel).toString(), QString("Relabeled0"));
+
+        filtersModel->update(filtersA);
+        QCOMPARE(opts->rowCount(), numOptions);
+        for (int i = 0; i < numOptions; i++) {
+            auto idx = opts->index(i, 0);
+            QCOMPARE(opts->data(idx, uss::OptionSelectorOptionsInterface::Roles::RoleOptionId).toString(), QString("o%1").arg(i));
+            QCOMPARE(opts->data(idx, uss::OptionSelectorOptionsInterface::Roles::RoleOptionLabel).toString(), QString("Option%1").arg(i));
+        }
+    }
+
+    void benchmarkSyncReorderedOptions_data()
+    {
+        QTest::addColumn<bool>("reverse");
+
+        QTest::newRow("reversed") << true;
+        QTest::newRow("shuffled") << false;
+    }
+
+    void benchmarkSyncReorderedOptions()
+    {
+        QFETCH(bool, reverse);
+        const int numOptions = 1000;
+
+        // fb has the options of fa either in reverse order or in a fixed pseudo-random order,
+        // so that (almost) every row has to be moved
+        std::vector<int> order(numOptions);
+        for (int i = 0; i < numOptions; i++) {
+            order[i] = i;
+        }
+        if (reverse) {
+            std::reverse(order.begin(), order.end());
+        } else {
+            unsigned int seed = 1;
+            for (int i = numOptions - 1; i > 0; i--) {
+                seed = seed * 1103515245 + 12345;
+                std::swap(order[i], order[(seed >> 16) % (i + 1)]);
+            }
+        }
+
+        unity::scopes::OptionSelectorFilter::SPtr fa = unity::scopes::OptionSelectorFilter::create("f3", "Filter3", true);
+        unity::scopes::OptionSelectorFilter::SPtr fb = unity::scopes::OptionSelectorFilter::create("f3", "Filter3", true);
+        for (int i = 0; i < numOptions; i++) {
+            fa->add_option("o" + std::to_string(i), "Option" + std::to_string(i));
+            fb->add_option("o" + std::to_string(order[i]), "Option" + std::to_string(order[i]));
+        }
+
+        QList<unity::scopes::FilterBase::SCPtr> filtersA;
+        filtersA.append(fa);
+        QList<unity::scopes::FilterBase::SCPtr> filtersB;
+        filtersB.append(fb);
+
+        filtersModel->update(filtersA);
+        auto opf = filtersModel->data(filtersModel->index(0, 0), uss::FiltersInterface::Roles::RoleFilter).value<OptionSelectorFilter*>();
+        QVERIFY(opf != nullptr);
+        auto opts = opf->options();
+        QVERIFY(opts != nullptr);
+
+        QBENCHMARK {
+            filtersModel->update(filtersB);
+            filtersModel->update(filtersA);
+        }
+
+        filtersModel->update(filtersB);
+        QCOMPARE(opts->rowCount(), numOptions);
+        for (int i = 0; i < numOptions; i++) {
+            QCOMPARE(opts->data(opts->index(i, 0), uss::OptionSelectorOptionsInterface::Roles::RoleOptionId).toString(), QString("o%1").arg(order[i]));
+        }
+    }
+
 private:
     unity::scopes::FilterState filterState;
     QScopedPointer<Filters> filtersModel;
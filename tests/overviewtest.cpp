@@ -104,6 +104,62 @@ private Q_SLOTS:
         OverviewResultsModel* results = results_var.value<OverviewResultsModel*>();
         QVERIFY(results->rowCount() == 2);
     }
+
+    void testChildScopesFetchedInBackground()
+    {
+        auto metadata = m_scopes->getCachedMetadata("mock-scope-departments");
+        QVERIFY(bool(metadata));
+        QVERIFY(metadata->is_aggregator());
+
+        QMap<QString, QString> names;
+        names["mock-scope-departments"] = "Departments";
+        names["mock-scope-double-nav"] = "Double nav";
+        names["mock-scope"] = "Mock";
+
+        OverviewResultsModel model;
+        QSignalSpy spy(&model, SIGNAL(dataChanged(const QModelIndex&, const QModelIndex&, const QVector<int>&)));
+        model.setResults({metadata}, names);
+        QCOMPARE(model.rowCount(), 1);
+        // the aggregator's child scopes aren't known until the reply arrives
+        QCOMPARE(model.data(model.index(0), OverviewResultsModel::RoleSubtitle), QVariant());
+        QTRY_COMPARE(model.data(model.index(0), OverviewResultsModel::RoleSubtitle), QVariant(QString("Double nav, Mock")));
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.first().at(2).value<QVector<int>>(), QVector<int>({OverviewResultsModel::RoleSubtitle}));
+    }
+
+    void testChildScopesCache()
+    {
+        auto metadata = m_scopes->getCachedMetadata("mock-scope-departments");
+        QVERIFY(bool(metadata));
+
+        QMap<QString, QString> names;
+        names["mock-scope-departments"] = "Departments";
+        names["mock-scope-double-nav"] = "Double nav";
+        names["mock-scope"] = "Mock";
+
+        OverviewResultsModel model;
+        model.setResults({metadata}, names);
+        QTRY_COMPARE(model.data(model.index(0), OverviewResultsModel::RoleSubtitle), QVariant(QString("Double nav, Mock")));
+
+        // same metadata and same set of scopes: the cached child scopes are used right away
+        names["mock-scope"] = "Renamed";
+        model.setResults({metadata}, names);
+        QCOMPARE(model.data(model.index(0), OverviewResultsModel::RoleSubtitle), QVariant(QString("Double nav, Renamed")));
+
+        // a scope was installed: child scopes are enumerated again
+        names["mock-scope-ttl"] = "TTL";
+        names["mock-scope"] = "Installed";
+        model.setResults({metadata}, names);
+        QCOMPARE(model.data(model.index(0), OverviewResultsModel::RoleSubtitle), QVariant(QString("Double nav, Renamed")));
+        QTRY_COMPARE(model.data(model.index(0), OverviewResultsModel::RoleSubtitle), QVariant(QString("Double nav, Installed")));
+
+        // metadata of the aggregator changed: child scopes are enumerated again
+        auto changedMetadata = std::make_shared<unity::scopes::ScopeMetadata>(*metadata);
+        names["mock-scope"] = "Changed";
+        model.setResults({changedMetadata}, names);
+        QCOMPARE(model.data(model.index(0), OverviewResultsModel::RoleSubtitle), QVariant(QString("Double nav, Installed")));
+        QTRY_COMPARE(model.data(model.index(0), OverviewResultsModel::RoleSubtitle), QVariant(QString("Double nav, Changed")));
+    }
 };
 
 QTEST_GUILESS_MAIN(OverviewTest)
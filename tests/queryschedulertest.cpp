@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QTest>
+
+#include <queryscheduler.h>
+#include <scope.h>
+
+using namespace scopes_ng;
+
+class QuerySchedulerTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    // queries are identified by their object name; a started query runs until finish() is called
+    QObject* schedule(QString const& name, QueryScheduler::Priority priority)
+    {
+        QObject* query = new QObject(this);
+        query->setObjectName(name);
+        m_scheduler->scheduleQuery(query, m_scope.data(), priority,
+                [this, name]() { m_started.append(name); return true; },
+                [this, name]() { m_cancelled.append(name); });
+        return query;
+    }
+
+    void finish(QObject* query)
+    {
+        m_scheduler->unscheduleQuery(query);
+        delete query;
+    }
+
+private Q_SLOTS:
+    void init()
+    {
+        m_scope = Scope::newInstance(nullptr);
+        m_otherScope = Scope::newInstance(nullptr);
+        m_started.clear();
+        m_cancelled.clear();
+    }
+
+    void cleanup()
+    {
+        m_scheduler.reset();
+        m_scope.reset();
+        m_otherScope.reset();
+    }
+
+    void testPriorityOrder()
+    {
+        m_scheduler.reset(new QueryScheduler(1));
+
+        QObject* refresh = schedule("refresh", QueryScheduler::Priority::TtlRefresh);
+        QObject* prefetch = schedule("prefetch", QueryScheduler::Priority::BackgroundPrefetch);
+        QObject* invalidation = schedule("invalidation", QueryScheduler::Priority::ProgrammaticRefresh);
+        QObject* neighbour = schedule("neighbour", QueryScheduler::Priority::VisibleNeighbour);
+
+        QTRY_COMPARE(m_started, QStringList({"neighbour"}));
+        finish(neighbour);
+        QTRY_COMPARE(m_started, QStringList({"neighbour", "invalidation"}));
+        finish(invalidation);
+        QTRY_COMPARE(m_started, QStringList({"neighbour", "invalidation", "prefetch"}));
+        finish(prefetch);
+        QTRY_COMPARE(m_started, QStringList({"neighbour", "invalidation", "prefetch", "refresh"}));
+        finish(refresh);
+        QTRY_COMPARE(m_scheduler->runningCount(), 0);
+        QCOMPARE(m_scheduler->queuedCount(), 0);
+    }
+
+    void testConcurrencyCap()
+    {
+        m_scheduler.reset(new QueryScheduler(2));
+
+        QObject* first = schedule("first", QueryScheduler::Priority::BackgroundPrefetch);
+        schedule("second", QueryScheduler::Priority::BackgroundPrefetch);
+        schedule("third", QueryScheduler::Priority::BackgroundPrefetch);
+        schedule("fourth", QueryScheduler::Priority::BackgroundPrefetch);
+
+        QTRY_COMPARE(m_scheduler->runningCount(), 2);
+        QTest::qWait(100);
+        QCOMPARE(m_started.size(), 2);
+        QCOMPARE(m_scheduler->queuedCount(), 2);
+
+        finish(first);
+        QTRY_COMPARE(m_started.size(), 3);
+        QCOMPARE(m_scheduler->runningCount(), 2);
+        QCOMPARE(m_scheduler->queuedCount(), 1);
+    }
+
+    void testInteractivePreemptsAndRequeues()
+    {
+        m_scheduler.reset(new QueryScheduler(2));
+
+        schedule("first", QueryScheduler::Priority::BackgroundPrefetch);
+        schedule("second", QueryScheduler::Priority::TtlRefresh);
+        QTRY_COMPARE(m_scheduler->runningCount(), 2);
+
+        // running queries are cancelled and nothing starts while the user interacts with a scope
+        m_scheduler->beginInteractive(m_otherScope.data());
+        QCOMPARE(m_scheduler->runningCount(), 0);
+        QCOMPARE(m_scheduler->queuedCount(), 2);
+        m_cancelled.sort();
+        QCOMPARE(m_cancelled, QStringList({"first", "second"}));
+
+        schedule("third", QueryScheduler::Priority::VisibleNeighbour);
+        QTest::qWait(100);
+        QCOMPARE(m_started.size(), 2);
+
+        // preempted queries are dispatched again, together with the new ones
+        m_scheduler->endInteractive(m_otherScope.data());
+        QTRY_COMPARE(m_started.size(), 4);
+        QCOMPARE(m_started.mid(2), QStringList({"third", "first"}));
+        QCOMPARE(m_scheduler->runningCount(), 2);
+        QCOMPARE(m_scheduler->queuedCount(), 1);
+    }
+
+    void testRescheduleKeepsHigherPriority()
+    {
+        m_scheduler.reset(new QueryScheduler(1));
+
+        QObject* blocker = schedule("blocker", QueryScheduler::Priority::ActiveInteractive);
+        QObject* query = schedule("query", QueryScheduler::Priority::TtlRefresh);
+        schedule("prefetch", QueryScheduler::Priority::BackgroundPrefetch);
+        m_scheduler->scheduleQuery(query, m_scope.data(), QueryScheduler::Priority::VisibleNeighbour,
+                [this]() { m_started.append("query"); return true; }, []() {});
+        QCOMPARE(m_scheduler->queuedCount(), 3);
+
+        QTRY_COMPARE(m_started, QStringList({"blocker"}));
+        finish(blocker);
+        QTRY_COMPARE(m_started, QStringList({"blocker", "query"}));
+    }
+
+    void testDestroyedQueryIsDropped()
+    {
+        m_scheduler.reset(new QueryScheduler(1));
+
+        QObject* running = schedule("running", QueryScheduler::Priority::BackgroundPrefetch);
+        QTRY_COMPARE(m_scheduler->runningCount(), 1);
+        delete schedule("deleted", QueryScheduler::Priority::VisibleNeighbour);
+
+        finish(running);
+        QTRY_COMPARE(m_scheduler->runningCount(), 0);
+        QCOMPARE(m_scheduler->queuedCount(), 0);
+        QCOMPARE(m_started, QStringList({"running"}));
+    }
+
+    void testAlignRefreshDelay()
+    {
+        m_scheduler.reset(new QueryScheduler(1));
+
+        QCOMPARE(m_scheduler->alignRefreshDelay(0), 0);
+        QCOMPARE(m_scheduler->alignRefreshDelay(-1), -1);
+
+        // refreshes due at about the same time end up in the same slot
+        const int first = m_scheduler->alignRefreshDelay(61000);
+        const int second = m_scheduler->alignRefreshDelay(63000);
+        QVERIFY(first >= 61000);
+        QVERIFY(second >= 63000);
+        QVERIFY(qAbs(first - second) < 100);
+
+        // short TTLs aren't postponed by more than a fifth
+        QCOMPARE(m_scheduler->alignRefreshDelay(1000), 1000);
+    }
+
+private:
+    QScopedPointer<QueryScheduler> m_scheduler;
+    Scope::Ptr m_scope;
+    Scope::Ptr m_otherScope;
+    QStringList m_started;
+    QStringList m_cancelled;
+};
+
+QTEST_GUILESS_MAIN(QuerySchedulerTest)
+#include <queryschedulertest.moc>
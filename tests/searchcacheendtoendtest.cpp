@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QScopedPointer>
+#include <QTest>
+#include <scopes.h>
+#include <scope.h>
+#include "categories.h"
+#include <scope-harness/registry/pre-existing-registry.h>
+#include <scope-harness/test-utils.h>
+#include <unity/shell/scopes/ResultsModelInterface.h>
+
+using namespace unity::scopeharness;
+using namespace unity::scopeharness::registry;
+using namespace scopes_ng;
+namespace uss = unity::shell::scopes;
+
+// mock-scope-ttl titles its result with the search query followed by a search counter,
+// so every search that actually reaches the scope produces a new title.
+class SearchCacheEndToEndTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    QSharedPointer<uss::ResultsModelInterface> results() const
+    {
+        auto categories = m_scope->categories();
+        if (categories == nullptr || categories->rowCount() == 0) {
+            return QSharedPointer<uss::ResultsModelInterface>();
+        }
+        return categories->data(categories->index(0, 0),
+                Categories::RoleResultsSPtr).value<QSharedPointer<uss::ResultsModelInterface>>();
+    }
+
+    QString resultTitle() const
+    {
+        auto model = results();
+        if (!model || model->rowCount() == 0) {
+            return QString();
+        }
+        return model->data(model->index(0, 0), uss::ResultsModelInterface::RoleTitle).toString();
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_registry.reset(new PreExistingRegistry(TEST_RUNTIME_CONFIG));
+        m_registry->start();
+    }
+
+    void cleanupTestCase()
+    {
+        m_registry.reset();
+    }
+
+    void init()
+    {
+        qputenv("UNITY_SCOPES_NO_PREPOPULATE_FIRST", "1");
+        qputenv("UNITY_SCOPES_TYPING_TIMEOUT_OVERRIDE", "0");
+        qputenv("UNITY_SCOPES_RESULTS_TTL_OVERRIDE", "60000");
+
+        const QStringList favs {"scope://mock-scope-ttl"};
+        TestUtils::setFavouriteScopes(favs);
+
+        m_scopes.reset(new Scopes(nullptr));
+
+        // wait till the registry spawns
+        QSignalSpy spy(m_scopes.data(), SIGNAL(loadedChanged()));
+        QVERIFY(spy.wait());
+        QCOMPARE(m_scopes->loaded(), true);
+
+        m_scope = m_scopes->getScopeById("mock-scope-ttl");
+        QVERIFY(m_scope != nullptr);
+        m_scope->setActive(true);
+    }
+
+    void cleanup()
+    {
+        m_scopes.reset();
+        m_scope.reset();
+        qunsetenv("UNITY_SCOPES_RESULTS_TTL_OVERRIDE");
+        qunsetenv("UNITY_SCOPES_TYPING_TIMEOUT_OVERRIDE");
+    }
+
+    void testRenderFromCache()
+    {
+        TestUtils::performSearch(m_scope, "a");
+        const QString first = resultTitle();
+        QVERIFY(first.startsWith("a"));
+        TestUtils::performSearch(m_scope, "b");
+        QVERIFY(resultTitle().startsWith("b"));
+
+        // going back renders the cached results, and doesn't search again while they are within the TTL
+        QSignalSpy progressSpy(m_scope.data(), SIGNAL(searchInProgressChanged()));
+        m_scope->setSearchQuery("a");
+        QTRY_COMPARE(resultTitle(), first);
+        QTest::qWait(500);
+        QCOMPARE(progressSpy.count(), 0);
+        QCOMPARE(resultTitle(), first);
+    }
+
+    void testRevalidateExpiredCache()
+    {
+        TestUtils::performSearch(m_scope, "a");
+        const QString first = resultTitle();
+        TestUtils::performSearch(m_scope, "b");
+
+        // cached results older than the TTL are rendered right away, then replaced by a new search
+        qputenv("UNITY_SCOPES_RESULTS_TTL_OVERRIDE", "100");
+        QTest::qWait(200);
+        m_scope->setSearchQuery("a");
+        QTRY_COMPARE(resultTitle(), first);
+        QTRY_VERIFY(resultTitle() != first);
+        QVERIFY(resultTitle().startsWith("a"));
+    }
+
+    void testFormFactorInvalidatesCache()
+    {
+        TestUtils::performSearch(m_scope, "a");
+        const QString first = resultTitle();
+        TestUtils::performSearch(m_scope, "b");
+
+        m_scope->setFormFactor(m_scope->formFactor() == QLatin1String("desktop") ? QStringLiteral("phone") : QStringLiteral("desktop"));
+
+        TestUtils::performSearch(m_scope, "a");
+        QVERIFY(resultTitle().startsWith("a"));
+        QVERIFY(resultTitle() != first);
+    }
+
+    void testBackgroundRevalidation()
+    {
+        TestUtils::performSearch(m_scope, "c");
+        const QString first = resultTitle();
+
+        // the TTL timer of an active scope revalidates its results in the background: current results
+        // stay visible and the search isn't reported as in progress
+        qputenv("UNITY_SCOPES_RESULTS_TTL_OVERRIDE", "300");
+        m_scope->refresh();
+        QTRY_VERIFY(resultTitle().startsWith("c") && resultTitle() != first && !m_scope->searchInProgress());
+        const QString second = resultTitle();
+        auto model = results();
+        QVERIFY(model);
+
+        QSignalSpy progressSpy(m_scope.data(), SIGNAL(searchInProgressChanged()));
+        QElapsedTimer timer;
+        timer.start();
+        int emptySamples = 0;
+        while (resultTitle() == second && timer.elapsed() < 10000) {
+            QTest::qWait(10);
+            if (model->rowCount() == 0) {
+                ++emptySamples;
+            }
+        }
+        QVERIFY(resultTitle() != second);
+        QVERIFY(resultTitle().startsWith("c"));
+        QCOMPARE(emptySamples, 0);
+        QCOMPARE(results(), model);
+        QCOMPARE(progressSpy.count(), 0);
+        QVERIFY(!m_scope->searchInProgress());
+    }
+
+private:
+    QScopedPointer<Scopes> m_scopes;
+    Scope::Ptr m_scope;
+    Registry::UPtr m_registry;
+};
+
+QTEST_GUILESS_MAIN(SearchCacheEndToEndTest)
+#include <searchcacheendtoendtest.moc>
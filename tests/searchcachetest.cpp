@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QObject>
+#include <QTest>
+
+#include <searchcache.h>
+#include <unity/scopes/OptionSelectorFilter.h>
+
+using namespace scopes_ng;
+
+class SearchCacheTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static CachedSearch makeSearch(std::string const& filterId)
+    {
+        CachedSearch search;
+        search.filters.append(unity::scopes::OptionSelectorFilter::create(filterId, "Filter"));
+        search.timestamp.start();
+        return search;
+    }
+
+    static QString filterId(CachedSearch const& search)
+    {
+        return QString::fromStdString(search.filters.first()->id());
+    }
+
+private Q_SLOTS:
+    void testLookup()
+    {
+        SearchCache cache(2);
+        CachedSearch search;
+        QVERIFY(!cache.lookup("scope://a", search));
+
+        cache.insert("scope://a", makeSearch("a"));
+        QVERIFY(cache.lookup("scope://a", search));
+        QCOMPARE(filterId(search), QString("a"));
+
+        // replacing an existing entry doesn't evict anything
+        cache.insert("scope://b", makeSearch("b"));
+        cache.insert("scope://a", makeSearch("a2"));
+        QCOMPARE(cache.count(), 2);
+        QVERIFY(cache.lookup("scope://a", search));
+        QCOMPARE(filterId(search), QString("a2"));
+        QVERIFY(cache.lookup("scope://b", search));
+    }
+
+    void testEviction()
+    {
+        SearchCache cache(2);
+        CachedSearch search;
+
+        cache.insert("scope://a", makeSearch("a"));
+        cache.insert("scope://b", makeSearch("b"));
+
+        // touch a, so that b becomes the least recently used
+        QVERIFY(cache.lookup("scope://a", search));
+        cache.insert("scope://c", makeSearch("c"));
+
+        QCOMPARE(cache.count(), 2);
+        QVERIFY(cache.lookup("scope://a", search));
+        QVERIFY(!cache.lookup("scope://b", search));
+        QVERIFY(cache.lookup("scope://c", search));
+
+        cache.clear();
+        QCOMPARE(cache.count(), 0);
+        QVERIFY(!cache.lookup("scope://a", search));
+    }
+
+    void testTrim()
+    {
+        SearchCache cache(3);
+        CachedSearch search;
+
+        cache.insert("scope://a", makeSearch("a"));
+        cache.insert("scope://b", makeSearch("b"));
+        cache.insert("scope://c", makeSearch("c"));
+        QVERIFY(cache.lookup("scope://a", search));
+
+        // keeps the most recently used search only
+        cache.trim(1);
+        QCOMPARE(cache.count(), 1);
+        QVERIFY(cache.lookup("scope://a", search));
+        QVERIFY(!cache.contains("scope://b"));
+        QVERIFY(!cache.contains("scope://c"));
+        QCOMPARE(cache.memoryUsage(), qint64(0));
+    }
+
+    void testDisabled()
+    {
+        SearchCache cache(0);
+        CachedSearch search;
+
+        cache.insert("scope://a", makeSearch("a"));
+        QCOMPARE(cache.count(), 0);
+        QVERIFY(!cache.lookup("scope://a", search));
+    }
+
+    void testLocationKey()
+    {
+        const QString key = SearchCache::locationKey("scope://a", 51.5142, -0.0931);
+        QVERIFY(key.startsWith("scope://a"));
+        QVERIFY(key != "scope://a");
+
+        // positions within the same ~1 km cell share the key, positions further apart don't
+        QCOMPARE(SearchCache::locationKey("scope://a", 51.5138, -0.0929), key);
+        QVERIFY(SearchCache::locationKey("scope://a", 51.5342, -0.0931) != key);
+        QVERIFY(SearchCache::locationKey("scope://a", 51.5142, -0.1131) != key);
+        QVERIFY(SearchCache::locationKey("scope://b", 51.5142, -0.0931) != key);
+    }
+};
+
+QTEST_GUILESS_MAIN(SearchCacheTest)
+#include <searchcachetest.moc>
@@ -19,6 +19,7 @@
 
 #include <QJsonDocument>
 #include <QObject>
+#include <QSignalSpy>
 #include <QTemporaryDir>
 #include <QTest>
 
@@ -118,12 +119,12 @@ private:
 
     QSharedPointer<SettingsModelInterface> settings;
 
-    void newSettingsModel(const QString& id, const QByteArray& json)
+    void newSettingsModel(const QString& id, const QByteArray& json, int settingsTimeout = 0)
     {
         QJsonDocument doc = QJsonDocument::fromJson(json);
         QVariant definitions = doc.toVariant();
         settings.reset(
-                new SettingsModel(tempDir->path(), id, definitions, 0, 0));
+                new SettingsModel(tempDir->path(), id, definitions, 0, 0, settingsTimeout));
     }
 
     void verifyData(int index, const QString& id, const QString& displayName,
@@ -289,6 +290,33 @@ private Q_SLOTS:
         verifyValue(3, false);
     }
 
+    void testCoalescedWrites()
+    {
+        newSettingsModel("coalesced", MIXED_DEFINITION, 200);
+        verifyValue(0, "London");
+
+        QSignalSpy settingsChangedSpy(settings.data(), SIGNAL(settingsChanged()));
+
+        // changes made within the timeout are written together
+        setValue(0, "Banana");
+        setValue(2, 123);
+        QTest::qWait(50);
+        setValue(3, false);
+        QVERIFY(settingsChangedSpy.wait());
+        QTest::qWait(400);
+        QCOMPARE(settingsChangedSpy.count(), 1);
+
+        // settings.ini is replaced on write, the lock file stays
+        QDir settingsDir(QDir(tempDir->path()).filePath("coalesced"));
+        QCOMPARE(settingsDir.entryList(QDir::Files), QStringList({"settings.ini", "settings.ini.lock"}));
+
+        newSettingsModel("coalesced", MIXED_DEFINITION);
+        verifyValue(0, "Banana");
+        verifyValue(1, 1);
+        verifyValue(2, 123);
+        verifyValue(3, false);
+    }
+
     void testReadUnicode()
     {
         QDir configDir(tempDir->path());
@@ -304,6 +332,28 @@ private Q_SLOTS:
         // Verify the initial values
         verifyValue(0, "北京京");
     }
+
+    void testExternalChange()
+    {
+        newSettingsModel("external", MIXED_DEFINITION);
+        verifyValue(0, "London");
+        verifyValue(2, 23);
+
+        QSignalSpy settingsChangedSpy(settings.data(), SIGNAL(settingsChanged()));
+
+        // Another process writes the settings file
+        QDir configDir(tempDir->path());
+        QFile iniFile(configDir.filePath("external/settings.ini"));
+        QVERIFY(iniFile.open(QFile::WriteOnly | QFile::Truncate));
+        iniFile.write("[General]\nlocationSetting=Paris\nageSetting=42\n");
+        iniFile.close();
+
+        verifyValue(0, "Paris");
+        verifyValue(1, 1);
+        verifyValue(2, 42);
+        verifyValue(3, true);
+        QVERIFY(settingsChangedSpy.count() > 0);
+    }
 };
 
 }
@@ -29,6 +29,75 @@
 using namespace scopes_ng;
 using namespace unity;
 
+namespace
+{
+
+enum class Payload
+{
+    DeepDict,
+    LargeArray,
+    Mixed
+};
+
+// a dict nested 'depth' levels deep, with a few scalar siblings at every level
+scopes::Variant deepDict(int depth)
+{
+    scopes::VariantMap dict;
+    dict["title"] = scopes::Variant("level " + std::to_string(depth));
+    dict["index"] = scopes::Variant(depth);
+    if (depth > 0) {
+        dict["child"] = deepDict(depth - 1);
+    }
+    return scopes::Variant(dict);
+}
+
+scopes::Variant largeArray(int size)
+{
+    scopes::VariantArray arr;
+    arr.reserve(size);
+    for (int i = 0; i < size; i++) {
+        arr.push_back(scopes::Variant("item" + std::to_string(i)));
+    }
+    return scopes::Variant(arr);
+}
+
+// resembles preview widget data: an array of attribute dicts plus nested metadata
+scopes::Variant mixedPayload()
+{
+    scopes::VariantArray attributes;
+    for (int i = 0; i < 50; i++) {
+        scopes::VariantMap attr;
+        attr["value"] = scopes::Variant("Attribute value " + std::to_string(i));
+        attr["icon"] = scopes::Variant("file:///usr/share/icons/icon" + std::to_string(i) + ".png");
+        attr["rating"] = scopes::Variant(i * 0.1);
+        attr["enabled"] = scopes::Variant(i % 2 == 0);
+        attributes.push_back(scopes::Variant(attr));
+    }
+    scopes::VariantMap payload;
+    payload["attributes"] = scopes::Variant(attributes);
+    payload["metadata"] = deepDict(5);
+    payload["tags"] = largeArray(100);
+    payload["summary"] = scopes::Variant("Zażółć gęślą jaźń");
+    return scopes::Variant(payload);
+}
+
+scopes::Variant createPayload(Payload payload)
+{
+    switch (payload) {
+        case Payload::DeepDict:
+            return deepDict(50);
+        case Payload::LargeArray:
+            return largeArray(10000);
+        case Payload::Mixed:
+            return mixedPayload();
+    }
+    return scopes::Variant();
+}
+
+}
+
+Q_DECLARE_METATYPE(Payload)
+
 class UtilsTest : public QObject
 {
     Q_OBJECT
@@ -108,6 +177,92 @@ private Q_SLOTS:
         QCOMPARE(qVariantToScopeVariant(dict.value("last")), v3);
         QCOMPARE(qVariantToScopeVariant(dict), scopes::Variant(vm));
     }
+
+    void testNonAsciiConversions()
+    {
+        scopes::Variant v1("Zażółć gęślą jaźń");
+        QCOMPARE(scopeVariantToQVariant(v1).toString(), QString::fromUtf8("Zażółć gęślą jaźń"));
+        QCOMPARE(qVariantToScopeVariant(QVariant(QString::fromUtf8("Zażółć gęślą jaźń"))), v1);
+        QCOMPARE(qVariantToScopeVariant(QVariant(QString())), scopes::Variant(""));
+
+        scopes::VariantMap vm;
+        vm["ключ"] = v1;
+        vm["key"] = scopes::Variant("value");
+        vm["\xf0\x9f\x98\x80"] = scopes::Variant(1);
+        QVariantMap dict = scopeVariantToQVariant(scopes::Variant(vm)).toMap();
+        QCOMPARE(dict.size(), 3);
+        QCOMPARE(dict.value(QString::fromUtf8("ключ")).toString(), QString::fromUtf8("Zażółć gęślą jaźń"));
+        QCOMPARE(dict.value(QString::fromUtf8("\xf0\x9f\x98\x80")).toInt(), 1);
+        QCOMPARE(qVariantToScopeVariant(dict), scopes::Variant(vm));
+    }
+
+    void testBackgroundUris()
+    {
+        QCOMPARE(backgroundUriToVariant("http://example.com/bg.png"), QVariant(QString("http://example.com/bg.png")));
+
+        QVariantMap color(backgroundUriToVariant("color:///#ff0000").toMap());
+        QCOMPARE(color.value("type").toString(), QString("color"));
+        QCOMPARE(color.value("elements").toList(), QVariantList() << QString("#ff0000"));
+
+        QVariantMap gradient(backgroundUriToVariant("gradient:///#ff0000/#00ff00").toMap());
+        QCOMPARE(gradient.value("type").toString(), QString("gradient"));
+        QCOMPARE(gradient.value("elements").toList(), QVariantList() << QString("#ff0000") << QString("#00ff00"));
+
+        // repeated lookups share the parsed value
+        QVariantMap gradient2(backgroundUriToVariant("gradient:///#ff0000/#00ff00").toMap());
+        QVERIFY(gradient2.isSharedWith(gradient));
+    }
+
+    void testNestedRoundTrip_data()
+    {
+        QTest::addColumn<Payload>("payload");
+
+        QTest::newRow("deep dict") << Payload::DeepDict;
+        QTest::newRow("large array") << Payload::LargeArray;
+        QTest::newRow("mixed") << Payload::Mixed;
+    }
+
+    void testNestedRoundTrip()
+    {
+        QFETCH(Payload, payload);
+
+        const scopes::Variant variant(createPayload(payload));
+        QCOMPARE(qVariantToScopeVariant(scopeVariantToQVariant(variant)), variant);
+    }
+
+    void benchmarkScopeVariantToQVariant_data()
+    {
+        testNestedRoundTrip_data();
+    }
+
+    void benchmarkScopeVariantToQVariant()
+    {
+        QFETCH(Payload, payload);
+
+        const scopes::Variant variant(createPayload(payload));
+        QVariant result;
+        QBENCHMARK {
+            result = scopeVariantToQVariant(variant);
+        }
+        QVERIFY(result.isValid());
+    }
+
+    void benchmarkQVariantToScopeVariant_data()
+    {
+        testNestedRoundTrip_data();
+    }
+
+    void benchmarkQVariantToScopeVariant()
+    {
+        QFETCH(Payload, payload);
+
+        const QVariant variant(scopeVariantToQVariant(createPayload(payload)));
+        scopes::Variant result;
+        QBENCHMARK {
+            result = qVariantToScopeVariant(variant);
+        }
+        QVERIFY(!result.is_null());
+    }
 };
 
 QTEST_GUILESS_MAIN(UtilsTest)